@@ -292,12 +292,201 @@ juce::String RotarySliderWithLabels::getDisplayString() const
     return str;
 }
 
+//==============================================================================
+juce::Image BackgroundImageCache::getImage(int width, int height, float scale,
+                                           const std::function<void(juce::Graphics&)>& draw)
+{
+    using namespace juce;
+
+    if ( width <= 0 || height <= 0 || scale <= 0.f )
+        return {};
+
+    const auto scaleKey = roundToInt(scale * 100.f);
+
+    for ( auto it = entries.begin(); it != entries.end(); ++it )
+    {
+        if ( it->width == width && it->height == height && it->scaleKey == scaleKey )
+        {
+            // most recently used goes to the front
+            entries.splice(entries.begin(), entries, it);
+            return entries.front().image;
+        }
+    }
+
+    // transparent between the grid lines: the OpenGL traces show through
+    Image image(Image::PixelFormat::ARGB,
+                jmax(1, roundToInt((float)width * scale)),
+                jmax(1, roundToInt((float)height * scale)),
+                true);
+    {
+        Graphics g(image);
+        g.addTransform(AffineTransform::scale(scale));
+        draw(g);
+    }
+
+    entries.push_front({ width, height, scaleKey, image });
+    totalBytes += getNumBytes(image);
+
+    // evict the least recently used, but always keep the one we just made
+    // (an editor still holding an evicted image keeps it alive, juce::Image is reference counted)
+    while ( totalBytes > maxBytes && entries.size() > 1 )
+    {
+        totalBytes -= getNumBytes(entries.back().image);
+        entries.pop_back();
+    }
+
+    return image;
+}
+
+size_t BackgroundImageCache::getNumBytes(const juce::Image& image)
+{
+    // ARGB
+    return (size_t)image.getWidth() * (size_t)image.getHeight() * 4;
+}
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+//==============================================================================
+AnalyzerGLRenderer::AnalyzerGLRenderer(juce::Component& componentToDrawOn)
+{
+    context.setRenderer(this);
+    // the component's paint() still runs, JUCE draws it over renderOpenGL()
+    context.setComponentPaintingEnabled(true);
+    // only render when something is pushed / the component repaints
+    context.setContinuousRepainting(false);
+    context.attachTo(componentToDrawOn);
+}
+
+AnalyzerGLRenderer::~AnalyzerGLRenderer()
+{
+    // stops the GL thread, openGLContextClosing() runs before this returns
+    context.detach();
+}
+
+void AnalyzerGLRenderer::newOpenGLContextCreated()
+{
+    using namespace juce;
+
+    // analysis area coordinates -> component pixels (y down) -> clip space
+    const String vertexShader =
+        "attribute vec2 position;\n"
+        "uniform vec2 viewSize;\n"
+        "uniform vec2 origin;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 pixel = position + origin;\n"
+        "    gl_Position = vec4(pixel.x / viewSize.x * 2.0 - 1.0, 1.0 - pixel.y / viewSize.y * 2.0, 0.0, 1.0);\n"
+        "}\n";
+
+    const String fragmentShader =
+        "uniform " JUCE_MEDIUMP " vec4 colour;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = colour;\n"
+        "}\n";
+
+    auto program = std::make_unique<OpenGLShaderProgram>(context);
+
+    if ( ! program->addVertexShader(OpenGLHelpers::translateVertexShaderToV3(vertexShader))
+        || ! program->addFragmentShader(OpenGLHelpers::translateFragmentShaderToV3(fragmentShader))
+        || ! program->link() )
+    {
+        DBG("analyzer shaders: " << program->getLastError());
+        failed = true;
+        return;
+    }
+
+    shader = std::move(program);
+    viewSizeUniform = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "viewSize");
+    originUniform = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "origin");
+    colourUniform = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "colour");
+    positionAttribute = std::make_unique<OpenGLShaderProgram::Attribute>(*shader, "position");
+
+    gl::glGenBuffers(1, &vertexBuffer);
+}
+
+void AnalyzerGLRenderer::openGLContextClosing()
+{
+    if ( vertexBuffer != 0 )
+        juce::gl::glDeleteBuffers(1, &vertexBuffer);
+    vertexBuffer = 0;
+
+    positionAttribute.reset();
+    colourUniform.reset();
+    originUniform.reset();
+    viewSizeUniform.reset();
+    shader.reset();
+}
+
+void AnalyzerGLRenderer::renderOpenGL()
+{
+    using namespace juce;
+    using namespace juce::gl;
+
+    // the component layer is transparent where the traces go
+    OpenGLHelpers::clear(Colours::black);
+
+    if ( shader == nullptr )
+        return;
+
+    frameSlot.pullBySwapping(frame);
+    if ( frame.width <= 0 || frame.height <= 0 )
+        return;
+
+    const auto scale = (float)context.getRenderingScale();
+    glViewport(0, 0, roundToInt(scale * (float)frame.width), roundToInt(scale * (float)frame.height));
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader->use();
+    viewSizeUniform->set((GLfloat)frame.width, (GLfloat)frame.height);
+    originUniform->set(frame.origin.x, frame.origin.y);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+
+    for ( const auto& trace : frame.traces )
+    {
+        // x, y, x, bottom per point, at least two points
+        const auto numPoints = (int)(trace.fillStrip.size() / 4);
+        if ( numPoints < 2 )
+            continue;
+
+        // new data every frame: orphan the old store
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(trace.fillStrip.size() * sizeof(float)), trace.fillStrip.data(), GL_STREAM_DRAW);
+
+        // the filled spectrum: the whole strip, between the trace and the bottom of the analysis area
+        drawVertices(GL_TRIANGLE_STRIP, 2 * numPoints, 0, trace.colour.withAlpha(0.15f));
+        // the trace: every other vertex of the strip
+        drawVertices(GL_LINE_STRIP, numPoints, 4, trace.colour);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void AnalyzerGLRenderer::drawVertices(juce::uint32 primitive, int numVertices, int stride, juce::Colour colour)
+{
+    using namespace juce::gl;
+
+    colourUniform->set(colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha());
+
+    const auto attribute = (GLuint)positionAttribute->attributeID;
+    glVertexAttribPointer(attribute, 2, GL_FLOAT, GL_FALSE, (GLsizei)(stride * (int)sizeof(float)), nullptr);
+    glEnableVertexAttribArray(attribute);
+
+    glDrawArrays((GLenum)primitive, 0, (GLsizei)numVertices);
+
+    glDisableVertexAttribArray(attribute);
+}
+#endif
+
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : 
 audioProcessor(p),
 //leftChannelFifo(&audioProcessor.leftChannelFifo)
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
+leftPathProducer(fftPlans),
+rightPathProducer(fftPlans),
+midPathProducer(fftPlans),
+sidePathProducer(fftPlans)
 {
     // Constructor
     const auto& params = audioProcessor.getParameters();
@@ -314,13 +503,26 @@ rightPathProducer(audioProcessor.rightChannelFifo)
     // when first open the GUI, the curve should work
     updateChain();
 
+    // the FFTs and paths are made on the analyzer thread
+    analyzerThread.startThread();
+
     // start timer
-    startTimerHz(60);
+    startTimerHz(activeTimerHz);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
     // Destructor
+    analyzerThread.stopThread(1000);
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    // detach while we're still a whole component
+    glRenderer.reset();
+#endif
+
+    if ( isAnalyzerReader )
+        audioProcessor.removeAnalyzerReader();
+
     const auto& params = audioProcessor.getParameters();
     for (auto param : params)
     {
@@ -331,59 +533,527 @@ ResponseCurveComponent::~ResponseCurveComponent()
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
 {
     parametersChanged.set(true);
+
+    // the timer can only be touched on the message thread (e.g. a slider drag): back to full rate straight away
+    // everyone else (i.e. the audio thread during automation) is picked up by the next idle poll
+    if ( juce::MessageManager::existsAndIsCurrentThread() )
+        setTimerIdle(false);
+}
+
+void ResponseCurveComponent::setTimerIdle(bool shouldBeIdle)
+{
+    if ( timerIsIdle == shouldBeIdle )
+        return;
+
+    timerIsIdle = shouldBeIdle;
+    startTimerHz(shouldBeIdle ? idleTimerHz : activeTimerHz);
 }
 
 
-// move the code from timerCallback() to process()
-// and call process() in timerCallback()
-// notice "left" represents the general situation
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void PathProducer::addSamples(const float* src, int size, juce::int64 position)
+{
+    // if we missed some blocks (the ring overflowed, or the processor was prepared again)
+    // what's in the mono buffer isn't contiguous with the new data anymore
+    // so start filling it again and hold the FFT back until it's full
+    const auto isGap = position != nextBlockPosition;
+    if ( isGap )
+        samplesSinceGap = 0;
+
+    nextBlockPosition = position + size;
+
+    if ( useMultiResolution )
+    {
+        if ( isGap )
+            multiResolutionAnalyzer.restartLevels();
+
+        multiResolutionAnalyzer.addSamples(src, size, -48.f);
+        return;
+    }
+
+    // write the block into the circular buffer, span by span
+    // an FFT runs every 'hopSize' samples, however the host chopped the audio up
+    // (so the analyzer costs the same at 32 or 4096 sample buffers)
+    const auto ringSize = monoBuffer.getNumSamples();
+    auto* ring = monoBuffer.getWritePointer(0);
+
+    for (int remaining = size; remaining > 0; )
+    {
+        const auto numToWrite = juce::jmin(remaining, samplesUntilNextFFT, ringSize - ringWriteIndex);
+
+        juce::FloatVectorOperations::copy(ring + ringWriteIndex, src, numToWrite);
+        src += numToWrite;
+        remaining -= numToWrite;
+
+        ringWriteIndex += numToWrite;
+        if ( ringWriteIndex == ringSize )
+            ringWriteIndex = 0;
+
+        samplesSinceGap = juce::jmin(samplesSinceGap + numToWrite, ringSize);
+        samplesUntilNextFFT -= numToWrite;
+
+        if ( samplesUntilNextFFT == 0 )
+        {
+            samplesUntilNextFFT = hopSize;
+
+            // start sending the buffer to the generator (oldest sample first)
+            // and hand the frame to the averager straight away, so the generator's fifo never fills up
+            if ( samplesSinceGap == ringSize )
+            {
+                leftChannelFFTDataGenerator.produceFFTDataForRendering(ring, ringWriteIndex, -48.f);
+                addFFTFrames();
+            }
+        }
+    }
+}
+
+void PathProducer::addFFTFrames()
+{
+    const auto numBins = leftChannelFFTDataGenerator.getFFTSize() / 2;
+
+    // in place, no per-iteration vector
+    // every frame goes through the averager, so none is lost for the average / the peaks
+    auto addFrame = [this, numBins](const std::vector<float>& fftData)
+    {
+        averager.addFrame(fftData, numBins, frameSeconds);
+    };
+
+    while ( leftChannelFFTDataGenerator.readFFTData(addFrame) )
+        hasNewFrames = true;
+}
+
+void PathProducer::changeOrder(FFTOrder newOrder)
+{
+    if ( newOrder == leftChannelFFTDataGenerator.getOrder() )
+        return;
+
+    leftChannelFFTDataGenerator.changeOrder(newOrder);
+
+    // the bins mean something else now
+    averager.reset();
+    hasNewFrames = false;
+
+    // the ring was allocated for the biggest order, so this doesn't reallocate
+    monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize(), false, true, true);
+    monoBuffer.clear();
+    ringWriteIndex = 0;
+
+    // hold the FFT back until the bigger / smaller window is full of new audio
+    samplesSinceGap = 0;
+    samplesUntilNextFFT = hopSize;
+}
+
+//==============================================================================
+MultiResolutionAnalyzer::HalfBandDecimator::HalfBandDecimator()
+{
+    // windowed sinc, cutoff at half the nyquist: every other tap is 0
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(coefficients.data(), numTaps,
+                                                            juce::dsp::WindowingFunction<float>::kaiser,
+                                                            false, 5.f);
+
+    const auto centre = numTaps / 2;
+    float sum = 0.f;
+    for (int i = 0; i < numTaps; ++i)
+    {
+        const auto offset = i - centre;
+        const auto sinc = offset == 0 ? 1.f
+                        : (offset % 2 == 0 ? 0.f
+                                           : std::sin(juce::MathConstants<float>::halfPi * offset) / (juce::MathConstants<float>::halfPi * offset));
+        coefficients[i] *= 0.5f * sinc;
+        sum += coefficients[i];
+    }
+
+    // unity gain at DC, so all levels read the same dB
+    for (auto& c : coefficients)
+        c /= sum;
+
+    reset();
+}
+
+void MultiResolutionAnalyzer::HalfBandDecimator::reset()
+{
+    history.fill(0.f);
+    historyIndex = 0;
+    isOddSample = false;
+}
+
+int MultiResolutionAnalyzer::HalfBandDecimator::process(const float* input, int numSamples, float* output)
+{
+    constexpr auto centre = numTaps / 2;
+    int numOut = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        history[historyIndex] = history[historyIndex + numTaps] = input[i];
+        historyIndex = (historyIndex + 1) % numTaps;
+
+        isOddSample = ! isOddSample;
+        if ( isOddSample )
+            continue;
+
+        // oldest .. newest
+        const auto* window = history.data() + historyIndex;
+
+        // symmetric, and only the odd offsets are non zero
+        auto y = coefficients[centre] * window[centre];
+        for (int offset = 1; offset <= centre; offset += 2)
+            y += coefficients[centre - offset] * (window[centre - offset] + window[centre + offset]);
+
+        output[numOut++] = y;
+    }
+
+    return numOut;
+}
+
+MultiResolutionAnalyzer::MultiResolutionAnalyzer(const FFTPlans& plansToUse) :
+plans(plansToUse)
+{
+    for (int i = 0; i < maxNumLevels; ++i)
+    {
+        levels[i].ring.resize(fftSize, 0.f);
+        levels[i].spectrum.resize(numBins, 0.f);
+
+        // level 0 is the most expensive one and only shows the top octaves, half the frame rate is plenty there
+        levels[i].hopSize = i == 0 ? fftSize * 2 : fftSize;
+
+        decimatedChunks[i].resize(chunkSize);
+    }
+
+    fftData.resize(fftSize * 2, 0.f);
+}
+
+void MultiResolutionAnalyzer::prepare(double newSampleRate, float negativeInfinity)
+{
+    sampleRate = newSampleRate;
+
+    // the last level's octave has to reach down to 20Hz: sampleRate / (12 * 2^(numLevels - 1)) <= 20
+    numLevels = juce::jlimit(1, maxNumLevels, 1 + (int)std::ceil(std::log2(sampleRate / (12.0 * 20.0))));
+
+    for (auto& level : levels)
+        std::fill(level.spectrum.begin(), level.spectrum.end(), negativeInfinity);
+
+    restartLevels();
+
+    hasNewSpectra = false;
+    samplesSinceLastPull = 0;
+}
+
+void MultiResolutionAnalyzer::restartLevels()
+{
+    // the spectra stay on screen until the levels have enough new audio to replace them
+    for (auto& level : levels)
+    {
+        level.decimator.reset();
+        level.ringWriteIndex = 0;
+        level.samplesSinceGap = 0;
+        level.samplesUntilNextFFT = level.hopSize;
+    }
+}
+
+void MultiResolutionAnalyzer::addSamples(const float* samples, int numSamples, float negativeInfinity)
+{
+    samplesSinceLastPull += numSamples;
+
+    for (int remaining = numSamples; remaining > 0; )
+    {
+        const auto numToFeed = juce::jmin(remaining, chunkSize);
+        feedLevel(0, samples, numToFeed, negativeInfinity);
+        samples += numToFeed;
+        remaining -= numToFeed;
+    }
+}
+
+void MultiResolutionAnalyzer::feedLevel(int levelIndex, const float* samples, int numSamples, float negativeInfinity)
+{
+    auto& level = levels[levelIndex];
+    auto* ring = level.ring.data();
+
+    // same as PathProducer: write span by span, an FFT every hopSize samples once the ring is full
+    for (int remaining = numSamples, read = 0; remaining > 0; )
+    {
+        const auto numToWrite = juce::jmin(remaining, level.samplesUntilNextFFT, fftSize - level.ringWriteIndex);
+
+        juce::FloatVectorOperations::copy(ring + level.ringWriteIndex, samples + read, numToWrite);
+        read += numToWrite;
+        remaining -= numToWrite;
+
+        level.ringWriteIndex += numToWrite;
+        if ( level.ringWriteIndex == fftSize )
+            level.ringWriteIndex = 0;
+
+        level.samplesSinceGap = juce::jmin(level.samplesSinceGap + numToWrite, fftSize);
+        level.samplesUntilNextFFT -= numToWrite;
+
+        if ( level.samplesUntilNextFFT == 0 )
+        {
+            level.samplesUntilNextFFT = level.hopSize;
+
+            if ( level.samplesSinceGap == fftSize )
+                renderLevel(level, negativeInfinity);
+        }
+    }
+
+    // half the rate for the next level down
+    if ( levelIndex + 1 < numLevels )
+    {
+        auto* decimated = decimatedChunks[levelIndex].data();
+        const auto numDecimated = level.decimator.process(samples, numSamples, decimated);
+
+        if ( numDecimated > 0 )
+            feedLevel(levelIndex + 1, decimated, numDecimated, negativeInfinity);
+    }
+}
+
+void MultiResolutionAnalyzer::renderLevel(Level& level, float negativeInfinity)
+{
+    // oldest sample first
+    const auto* ring = level.ring.data();
+    const auto oldestIndex = level.ringWriteIndex;
+    std::copy(ring + oldestIndex, ring + fftSize, fftData.begin());
+    std::copy(ring, ring + oldestIndex, fftData.begin() + (fftSize - oldestIndex));
+
+    plans.getMultiResolutionWindow().multiplyWithWindowingTable(fftData.data(), fftSize);
+    plans.getMultiResolutionFFT().performFrequencyOnlyForwardTransform(fftData.data());
+
+    magnitudesToDecibels(fftData.data(), numBins, negativeInfinity);
+    std::copy(fftData.begin(), fftData.begin() + numBins, level.spectrum.begin());
+
+    hasNewSpectra = true;
+}
+
+bool MultiResolutionAnalyzer::pullNewSpectra(int& elapsedSamples)
+{
+    if ( ! hasNewSpectra )
+        return false;
+
+    elapsedSamples = samplesSinceLastPull;
+    samplesSinceLastPull = 0;
+    hasNewSpectra = false;
+    return true;
+}
+
+void MultiResolutionAnalyzer::updateColumnTable(int numColumns)
+{
+    if ( numColumns == (int)columnTable.size() && sampleRate == columnTableSampleRate )
+        return;
+
+    columnTable.resize(numColumns);
+    columnTableSampleRate = sampleRate;
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        // the same axis as the response curve: x = mapFromLog10(freq, 20, 20000) * width
+        const auto lowFreq = juce::mapToLog10((double)column / numColumns, 20.0, 20000.0);
+        const auto highFreq = juce::mapToLog10((double)(column + 1) / numColumns, 20.0, 20000.0);
+        const auto centreFreq = std::sqrt(lowFreq * highFreq);
+
+        // level k shows [fs_k / 12, fs_k / 6]
+        auto& entry = columnTable[column];
+        entry.level = juce::jlimit(0, numLevels - 1, (int)std::floor(std::log2(sampleRate / (6.0 * centreFreq))));
+
+        const auto binsPerHz = fftSize / (sampleRate / (1 << entry.level));
+        entry.firstBin = juce::jmax(0, (int)std::ceil(lowFreq * binsPerHz));
+        entry.lastBin = juce::jmin(numBins - 1, (int)std::floor(highFreq * binsPerHz));
+        entry.fraction = -1.f;
+
+        // narrower than a bin: interpolate between the two bins around the centre
+        if ( entry.firstBin > entry.lastBin )
+        {
+            const auto position = juce::jlimit(0.0, (double)(numBins - 2), centreFreq * binsPerHz);
+            entry.firstBin = (int)position;
+            entry.lastBin = entry.firstBin + 1;
+            entry.fraction = (float)(position - entry.firstBin);
+        }
+    }
+}
+
+void MultiResolutionAnalyzer::renderColumns(std::vector<float>& columnLevels, int numColumns)
 {
-    // while there are buffers to pull
-    // if we can pull a buffer
-    // we are going to send it to the fft data generator
-    // the first thing we need is a temp buffer to pull into
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    jassert(numColumns <= (int)columnLevels.size());
+    updateColumnTable(numColumns);
 
-    while ( leftChannelFifo->getNumCompleteBuffersAvailable() )
-    // there are more than zero buffers available to be pulled
+    for (int column = 0; column < numColumns; ++column)
     {
-        // let try to pull one
-        if ( leftChannelFifo->getAudioBuffer(tempIncomingBuffer) )
+        const auto& entry = columnTable[column];
+        const auto* spectrum = levels[entry.level].spectrum.data();
+
+        if ( entry.fraction >= 0.f )
         {
-            // if we can pull one of these
-            // we are going to send it to the fft data generator
-            // but we must make sure that they stay in the same order and the blocks being sent to fft data generator is the right size
-            // so let's create a mono buffer first
-
-            auto size = tempIncomingBuffer.getNumSamples();
-
-            // FloatVectorOperations::copy(float* dest, const float* src, int num)
-            //               |            original data                 |  | new data |
-            //               ............................................  ............ 
-            //               0                                          n  <-- size -->
-            // after the first copy
-            // |              original data                 |              | new data |
-            // ............  ................................              ............
-            // <-- size -->  0                              n - size       <-- size -->
-            // after the second copy
-            // |  no need |  |    part of original data     |  | new data |
-            // ............  ................................  ............
-            // <-- size -->  0                                            n
- 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                                              monoBuffer.getReadPointer(0, size),
-                                              monoBuffer.getNumSamples() - size);
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                                              tempIncomingBuffer.getReadPointer(0, 0),
-                                              size);
-
-            // start sending mono buffers to the generator
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+            columnLevels[column] = spectrum[entry.firstBin] + entry.fraction * (spectrum[entry.lastBin] - spectrum[entry.firstBin]);
+            continue;
+        }
+
+        auto level = spectrum[entry.firstBin];
+        for (int bin = entry.firstBin + 1; bin <= entry.lastBin; ++bin)
+            level = juce::jmax(level, spectrum[bin]);
+
+        columnLevels[column] = level;
+    }
+}
+
+//==============================================================================
+void SpectrumAverager::prepare(int maxNumBins)
+{
+    levels.resize(maxNumBins);
+    reset();
+}
+
+void SpectrumAverager::reset()
+{
+    // the next frame is copied as is
+    isEmpty = true;
+}
+
+void SpectrumAverager::setMode(AnalyzerMode newMode)
+{
+    if ( newMode == mode )
+        return;
+
+    mode = newMode;
+    reset();
+}
+
+void SpectrumAverager::setAveragingTime(float seconds)
+{
+    averagingTime = juce::jmax(0.001f, seconds);
+}
+
+void SpectrumAverager::setPeakDecay(float decibelsPerSecond)
+{
+    peakDecay = juce::jmax(0.f, decibelsPerSecond);
+}
+
+void SpectrumAverager::addFrame(const std::vector<float>& frame, int numBins, double frameSeconds)
+{
+    jassert(numBins <= (int)levels.size() && numBins <= (int)frame.size());
+    numBins = juce::jmin(numBins, (int)levels.size(), (int)frame.size());
 
+    auto* dest = levels.data();
+    const auto* src = frame.data();
+
+    if ( mode == AnalyzerMode::Latest || isEmpty )
+    {
+        juce::FloatVectorOperations::copy(dest, src, numBins);
+        isEmpty = false;
+        return;
+    }
+
+    switch ( mode )
+    {
+        case AnalyzerMode::Average:
+        {
+            // one pole in the dB domain, the same time constant whatever the hop size
+            const auto alpha = (float)(1.0 - std::exp(-frameSeconds / averagingTime));
+            for (int i = 0; i < numBins; ++i)
+                dest[i] += alpha * (src[i] - dest[i]);
+            break;
+        }
+        case AnalyzerMode::PeakHold:
+        {
+            // the held peaks fall back linearly (in dB) until a louder frame catches them
+            const auto decay = (float)(peakDecay * frameSeconds);
+            for (int i = 0; i < numBins; ++i)
+                dest[i] = juce::jmax(src[i], dest[i] - decay);
+            break;
+        }
+        case AnalyzerMode::MaxHold:
+        {
+            juce::FloatVectorOperations::max(dest, dest, src, numBins);
+            break;
         }
+        case AnalyzerMode::Latest:
+        default:
+            break;
+    }
+}
+
+//==============================================================================
+void PathProducer::setOverlap(float newOverlap)
+{
+    jassert(newOverlap >= 0.f && newOverlap < 1.f);
+    overlap = juce::jlimit(0.f, 0.99f, newOverlap);
+    hopMode = HopMode::FixedOverlap;
+}
+
+void PathProducer::setFramesPerSecond(double newFramesPerSecond)
+{
+    jassert(newFramesPerSecond > 0.0);
+    framesPerSecond = juce::jmax(1.0, newFramesPerSecond);
+    hopMode = HopMode::FixedFrameRate;
+}
+
+void PathProducer::updateHopSize(double sampleRate)
+{
+    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+
+    auto newHopSize = hopMode == HopMode::FixedOverlap
+                    ? juce::roundToInt(fftSize * (1.f - overlap))
+                    : juce::roundToInt(sampleRate / framesPerSecond);
+
+    hopSize = juce::jmax(1, newHopSize);
+    if ( sampleRate > 0.0 )
+        frameSeconds = hopSize / sampleRate;
+
+    // a shorter hop kicks in right away
+    samplesUntilNextFFT = juce::jmin(samplesUntilNextFFT, hopSize);
+}
+
+// move the code from timerCallback() to process()
+// and call process() from the analyzer thread (see runAnalysis())
+// notice "left" represents the general situation
+void PathProducer::setMultiResolution(bool shouldUseMultiResolution, double sampleRate)
+{
+    if ( shouldUseMultiResolution != useMultiResolution )
+    {
+        useMultiResolution = shouldUseMultiResolution;
+
+        // the other engine's audio is stale, and the averager's bins mean something else
+        samplesSinceGap = 0;
+        multiResolutionSampleRate = 0.0;
+        averager.reset();
+        hasNewFrames = false;
+    }
+
+    if ( useMultiResolution && sampleRate > 0.0 && sampleRate != multiResolutionSampleRate )
+    {
+        multiResolutionSampleRate = sampleRate;
+        multiResolutionAnalyzer.prepare(sampleRate, -48.f);
+        averager.reset();
+    }
+}
+
+void PathProducer::processMultiResolution(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+    int elapsedSamples = 0;
+    if ( ! multiResolutionAnalyzer.pullNewSpectra(elapsedSamples) )
+        return;
+
+    // one value per pixel column, the averager has room for this many
+    const auto numColumns = juce::jlimit(0, (int)multiResolutionColumns.size(), (int)fftBounds.getWidth());
+    if ( numColumns == 0 )
+        return;
+
+    if ( numColumns != numMultiResolutionColumns )
+    {
+        numMultiResolutionColumns = numColumns;
+        averager.reset();
+    }
+
+    multiResolutionAnalyzer.renderColumns(multiResolutionColumns, numColumns);
+    averager.addFrame(multiResolutionColumns, numColumns, elapsedSamples / sampleRate);
+    pathProducer.generatePathFromColumns(averager.getLevels(), numColumns, fftBounds, -48.f);
+}
+
+void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+    if ( useMultiResolution )
+    {
+        processMultiResolution(fftBounds, sampleRate);
+        return;
     }
 
+    // the audio was fed in by addSamples()
+    // the hop for the frame rate mode depends on the sample rate, which can change under us
+    updateHopSize(sampleRate);
 
     /*
     if there are FFT data buffers to pull
@@ -399,44 +1069,308 @@ void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
     //const auto binWidth = audioProcessor.getSampleRate() / (double)fftSize;
     const auto binWidth = sampleRate / (double)fftSize;
 
-    // if we have more than zero fft blocks available 
-    while ( leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0 )
+    // the frames went into the averager as addSamples() made them (see addFFTFrames())
+    // only the newest path gets drawn, so make one path per call, not one per frame
+    if ( hasNewFrames )
+        pathProducer.generatePath(averager.getLevels(), fftBounds, fftSize, binWidth, -48.f);
+
+    hasNewFrames = false;
+
+
+}
+
+void PathProducer::clearPaths()
+{
+    while ( pathProducer.getNumPathsAvailable() )
     {
-        std::vector<float> fftData;
-        // let try to pull one
-        if ( leftChannelFFTDataGenerator.getFFTData(fftData) ) 
-        {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
-        }
+        pathProducer.getOutput(latestOutput);
     }
 
+    latestOutput.path.clear();
+    latestOutput.fillStrip.clear();
+}
 
+bool PathProducer::pullLatestPath()
+{
     /*
     while there are paths that can be pull 
         pull as many as we can
             display the most recent path
     */
 
+    bool gotNewPath = false;
     while ( pathProducer.getNumPathsAvailable() )
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        gotNewPath = pathProducer.getOutput(latestOutput) || gotNewPath;
+    }
+
+    return gotNewPath;
+}
+
+// analyzer thread
+void ResponseCurveComponent::runAnalysis()
+{
+    analysisBoundsSlot.pull(analysisBounds);
+
+    if ( ! shouldshowFFTAnalysis || analysisBounds.isEmpty() )
+        return;
+
+    // only the pair on show is analysed
+    const auto channels = getAnalyzerChannels();
+    auto& first = channels == AnalyzerChannels::MidSide ? midPathProducer : leftPathProducer;
+    auto& second = channels == AnalyzerChannels::MidSide ? sidePathProducer : rightPathProducer;
+
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    // "Analyzer FFT Order": 0 = 2048, 1 = 4096, 2 = 8192, 3 = multi-resolution
+    const auto orderIndex = juce::jlimit(0, FFTPlans::numOrders,
+                                         (int)audioProcessor.apvts.getRawParameterValue("Analyzer FFT Order")->load());
+    const auto useMultiResolution = orderIndex == FFTPlans::numOrders;
+    const auto order = static_cast<FFTOrder>(FFTOrder::order2048 + juce::jmin(orderIndex, FFTPlans::numOrders - 1));
+
+    // "Analyzer Mode": same order as the AnalyzerMode enum
+    const auto mode = static_cast<AnalyzerMode>(juce::jlimit(0, (int)AnalyzerMode::MaxHold,
+                                                (int)audioProcessor.apvts.getRawParameterValue("Analyzer Mode")->load()));
+
+    const auto shouldResetHold = shouldResetAnalyzerHold.exchange(false);
+
+    for (auto* producer : { &first, &second })
+    {
+        producer->setMultiResolution(useMultiResolution, sampleRate);
+        if ( ! useMultiResolution )
+            producer->changeOrder(order);
+
+        producer->setMode(mode);
+
+        if ( shouldResetHold )
+            producer->resetHold();
+    }
+
+    // we are the only reader of the capture fifo
+    // every block goes to both path producers
+    auto& captureFifo = audioProcessor.captureFifo;
+
+    // we just started reading again, the blocks in the fifo are from before the pause
+    // (the new ones start after a jump in position, so the producers refill their windows)
+    if ( shouldFlushCapture.exchange(false) )
+    {
+        while ( captureFifo.readBlock([](const PathProducer::CapturedBlock&) { }) ) { }
+    }
+    while ( captureFifo.getNumCompleteBuffersAvailable() > 0 )
+    {
+        captureFifo.readBlock([this, channels](const PathProducer::CapturedBlock& block)
+        {
+            if ( channels == AnalyzerChannels::MidSide )
+                addMidSideBlock(block);
+            else
+                addLeftRightBlock(block);
+        });
+    }
+
+    first.process(analysisBounds, sampleRate);
+    second.process(analysisBounds, sampleRate);
+}
+
+// analyzer thread
+void ResponseCurveComponent::addLeftRightBlock(const PathProducer::CapturedBlock& block)
+{
+    const auto& stereo = block.buffer;
+    const auto numSamples = stereo.getNumSamples();
+    if ( stereo.getNumChannels() < 1 || numSamples < 1 )
+        return;
+
+    // a mono layout only has channel 0, both traces show it
+    const auto* left = stereo.getReadPointer(Channel::Left < stereo.getNumChannels() ? Channel::Left : 0);
+    const auto* right = stereo.getReadPointer(Channel::Right);
+
+    leftPathProducer.addSamples(left, numSamples, block.position);
+    rightPathProducer.addSamples(right, numSamples, block.position);
+}
+
+// analyzer thread
+void ResponseCurveComponent::addMidSideBlock(const PathProducer::CapturedBlock& block)
+{
+    const auto& stereo = block.buffer;
+    const auto numSamples = stereo.getNumSamples();
+    if ( stereo.getNumChannels() < 1 || numSamples < 1 )
+        return;
+
+    // only reallocates when a bigger block turns up
+    midSideBuffer.setSize(2, numSamples, false, false, true);
+    auto* mid = midSideBuffer.getWritePointer(0);
+    auto* side = midSideBuffer.getWritePointer(1);
+
+    const auto* left = stereo.getReadPointer(Channel::Left < stereo.getNumChannels() ? Channel::Left : 0);
+    const auto* right = stereo.getReadPointer(Channel::Right);
+
+    // mid = (L + R) / 2, side = (L - R) / 2, both in one pass (vectorised by the compiler)
+    // a mono capture has left == right, so side is silent
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto l = left[i];
+        const auto r = right[i];
+        mid[i] = 0.5f * (l + r);
+        side[i] = 0.5f * (l - r);
+    }
+
+    midPathProducer.addSamples(mid, numSamples, block.position);
+    sidePathProducer.addSamples(side, numSamples, block.position);
+}
+
+ResponseCurveComponent::AnalyzerChannels ResponseCurveComponent::getAnalyzerChannels() const
+{
+    return audioProcessor.apvts.getRawParameterValue("Analyzer Channels")->load() > 0.5f
+         ? AnalyzerChannels::MidSide
+         : AnalyzerChannels::LeftRight;
+}
+
+
+// message thread
+void ResponseCurveComponent::updateAnalyzerActivation()
+{
+    // isShowing() also covers a minimised / hidden window
+    const auto shouldRead = shouldshowFFTAnalysis.load() && isShowing();
+    if ( shouldRead == isAnalyzerReader )
+        return;
+
+    isAnalyzerReader = shouldRead;
+
+    if ( shouldRead )
+    {
+        // no stale data when we come back: old capture blocks, old paths, old holds
+        shouldFlushCapture = true;
+        shouldResetAnalyzerHold = true;
+
+        for (auto* producer : { &leftPathProducer, &rightPathProducer, &midPathProducer, &sidePathProducer })
+            producer->clearPaths();
+
+        audioProcessor.addAnalyzerReader();
+    }
+    else
+    {
+        audioProcessor.removeAnalyzerReader();
+    }
+}
+
+bool ResponseCurveComponent::isUsingOpenGL() const
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    return glRenderer != nullptr;
+#else
+    return false;
+#endif
+}
+
+// the context is still being made: keep the timer going so a failure is noticed
+bool ResponseCurveComponent::isWaitingForOpenGL() const
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    return glRenderer != nullptr && ! glRenderer->isActive() && ! glRenderer->hasFailed();
+#else
+    return false;
+#endif
+}
+
+// message thread
+void ResponseCurveComponent::updateRenderer()
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    const auto wantsOpenGL = audioProcessor.apvts.getRawParameterValue("Analyzer Renderer")->load() > 0.5f;
+
+    // choosing Software clears a failure, so OpenGL can be tried again
+    if ( ! wantsOpenGL )
+        glUnavailable = false;
+
+    if ( glRenderer != nullptr )
+    {
+        // no context after ~1s, or the shaders didn't compile: back to the path renderer
+        if ( ! glRenderer->isActive() )
+            ++glTicksWithoutContext;
+
+        if ( glRenderer->hasFailed() || glTicksWithoutContext > 60 )
+            glUnavailable = true;
+    }
+
+    const auto shouldUseOpenGL = wantsOpenGL && ! glUnavailable;
+    if ( shouldUseOpenGL == isUsingOpenGL() )
+        return;
+
+    if ( shouldUseOpenGL )
+    {
+        glTicksWithoutContext = 0;
+        glRenderer = std::make_unique<AnalyzerGLRenderer>(*this);
+        pushGLFrame();
+    }
+    else
+    {
+        glRenderer.reset();
     }
 
+    repaint();
+#endif
 }
 
+// message thread: the latest fill strips (made on the analyzer thread) and where to draw them
+void ResponseCurveComponent::pushGLFrame()
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if ( glRenderer == nullptr )
+        return;
+
+    using namespace juce;
+
+    const auto analysisArea = getAnalysisArea().toFloat();
+    const auto showMidSide = getAnalyzerChannels() == AnalyzerChannels::MidSide;
+
+    const std::array<PathProducer*, 2> producers
+    {
+        showMidSide ? &midPathProducer : &leftPathProducer,
+        showMidSide ? &sidePathProducer : &rightPathProducer
+    };
+    const std::array<Colour, 2> colours
+    {
+        showMidSide ? Colours::lightgreen : Colours::skyblue,
+        showMidSide ? Colours::orchid : Colours::lightyellow
+    };
+
+    // the analyzer thread already made the vertices: one copy into the frame's (reused) storage
+    glRenderer->pushFrame([&](AnalyzerGLRenderer::Frame& frame)
+    {
+        for ( size_t i = 0; i < producers.size(); ++i )
+        {
+            auto& trace = frame.traces[i];
+            trace.colour = colours[i];
+
+            if ( shouldshowFFTAnalysis )
+                trace.fillStrip = producers[i]->getFillStrip();
+            else
+                trace.fillStrip.clear();
+        }
+
+        frame.origin = analysisArea.getTopLeft();
+        frame.width = getWidth();
+        frame.height = getHeight();
+    });
+#endif
+}
 
 // familiar timer !
 void ResponseCurveComponent::timerCallback()
 {
+    // a new frame starts with every tick (the previous one includes its paint)
+    messageThreadFrameTime.endFrame();
+    FrameTimeMetric::ScopedTimer frameTimer(messageThreadFrameTime);
+
+    // there's no callback for a parent window being hidden / minimised
+    updateAnalyzerActivation();
+
     /***************************************************************************/
-    // call our process function
+    // the analyzer thread did the work, just swap in what it finished
+    bool analyzerChanged = false;
     if ( shouldshowFFTAnalysis )
     {
-        auto fftBounds = getAnalysisArea().toFloat();
-        auto sampleRate = audioProcessor.getSampleRate();
-
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        for (auto* producer : { &leftPathProducer, &rightPathProducer, &midPathProducer, &sidePathProducer })
+            analyzerChanged = producer->pullLatestPath() || analyzerChanged;
     }
 
     /***************************************************************************/
@@ -445,37 +1379,122 @@ void ResponseCurveComponent::timerCallback()
     // if the parameter has changed
     // we need to set the flag back to false
     // and update the coefficients and repaint
-    if (parametersChanged.compareAndSetBool(false, true))
+    // (a new filter sample rate, e.g. oversampling switched on, changes the curve too)
+    bool curveChanged = false;
+    if (parametersChanged.compareAndSetBool(false, true)
+        || audioProcessor.getFilterSampleRate() != lastFilterSampleRate)
     {
         //DBG( "params changed" );
         // update the monochain
         updateChain();
-        // signal a repaint
-        // the repaint function has already implemented
-        //repaint();
+        curveChanged = true;
     }
 
-    // we need to repaint all the time
-    // comment the repaint function above
-    repaint();
+    // software / OpenGL, and the traces for the GL thread
+    updateRenderer();
+    if ( analyzerChanged && isUsingOpenGL() )
+        pushGLFrame();
+
+    // only repaint what changed:
+    // the curve can go past the render area (it isn't clipped), so everything
+    // the analyzer traces stay inside the render area
+    if ( curveChanged )
+        repaint();
+    else if ( analyzerChanged )
+        repaint(getRenderArea());
+
+    // nothing to animate: idle until a parameter moves or the analyzer is switched on
+    // (the analyzer being on but the window hidden keeps the full rate: that's how we notice it coming back)
+    // (so does an OpenGL context that isn't up yet, see updateRenderer())
+    setTimerIdle(! shouldshowFFTAnalysis && ! curveChanged && ! isWaitingForOpenGL());
 }
 
 void ResponseCurveComponent::updateChain()
 {
     auto chainSettings = getChainSettings(audioProcessor.apvts);
+    auto sampleRate = audioProcessor.getFilterSampleRate();
+
+    // same design the audio thread gets from the coefficient designer
+    chainCoefficients = designChainCoefficients<double>(chainSettings, sampleRate);
+
+    // which bands have to be evaluated again?
+    const auto rateChanged = sampleRate != lastFilterSampleRate;
+
+    if ( rateChanged || lowCutSettingsChanged(chainSettings, lastChainSettings) )
+        bandNeedsUpdate[ChainPositions::LowCut] = true;
+
+    if ( rateChanged || peakSettingsChanged(chainSettings, lastChainSettings) )
+        bandNeedsUpdate[ChainPositions::Peak] = true;
+
+    if ( rateChanged || highCutSettingsChanged(chainSettings, lastChainSettings) )
+        bandNeedsUpdate[ChainPositions::HighCut] = true;
+
+    lastChainSettings = chainSettings;
+    lastFilterSampleRate = sampleRate;
+
+    updateResponseCurve();
+}
+
+void ResponseCurveComponent::updateResponseCurve()
+{
+    using namespace juce;
+
+    auto responseArea = getAnalysisArea();
+    auto w = juce::jmax(0, responseArea.getWidth());
+
+    // not prepared yet: nothing to evaluate (the timer notices when the rate turns up)
+    if ( lastFilterSampleRate <= 0.0 )
+    {
+        responseCurve.clear();
+        return;
+    }
+
+    // one frequency per pixel column, cos/sin tables made once per width / sample rate
+    if ( responseEvaluator.getNumFrequencies() != w || responseEvaluator.getSampleRate() != lastFilterSampleRate )
+    {
+        responseEvaluator.prepareLogGrid(w, lastFilterSampleRate);
+        bandNeedsUpdate.fill(true);
+    }
+
+    bool anyBandUpdated = false;
+    for (int band = 0; band < numCurveBands; ++band)
+    {
+        if ( bandNeedsUpdate[band] )
+        {
+            bandMagnitudes[band].resize(w);
+            responseEvaluator.getBandDecibels(chainCoefficients, static_cast<ChainPositions>(band), bandMagnitudes[band].data());
+            bandNeedsUpdate[band] = false;
+            anyBandUpdated = true;
+        }
+    }
+
+    if ( ! anyBandUpdated )
+        return;
+
+    responseCurve.clear();
+    if ( w <= 0 )
+        return;
 
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    const double outputMin = responseArea.getBottom();
+    const double outputMax = responseArea.getY();
+    auto map = [outputMin, outputMax](double input)
+    {
+        return jmap(input, -24.0, 24.0, outputMin, outputMax);
+    };
 
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    // the bands multiply, so their dB add up
+    auto magnitudeAt = [this](int i)
+    {
+        return bandMagnitudes[ChainPositions::LowCut][i] + bandMagnitudes[ChainPositions::Peak][i] + bandMagnitudes[ChainPositions::HighCut][i];
+    };
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    responseCurve.preallocateSpace(3 * w);
+    responseCurve.startNewSubPath(responseArea.getX(), map(magnitudeAt(0)));
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    for (int i = 1; i < w; ++i)
+    {
+        responseCurve.lineTo(responseArea.getX() + i, map(magnitudeAt(i)));
+    }
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
@@ -491,10 +1510,25 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
 
     using namespace juce;
 
-    g.fillAll(Colours::black);
+    FrameTimeMetric::ScopedTimer frameTimer(messageThreadFrameTime);
+
+    // with OpenGL the black and the analyzer traces are already underneath us
+    const auto usingOpenGL = isUsingOpenGL();
+    if ( ! usingOpenGL )
+        g.fillAll(Colours::black);
 
     /* draw grid background */
-    g.drawImage(background, getLocalBounds().toFloat());
+    // rendered at the display's pixel scale, so a new scale (other monitor, host zoom) needs another image
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if ( ! background.isValid() || scale != backgroundScale )
+    {
+        background = backgroundCache->getImage(getWidth(), getHeight(), scale,
+                                               [this](Graphics& bg) { drawBackground(bg); });
+        backgroundScale = scale;
+    }
+
+    if ( background.isValid() )
+        g.drawImage(background, getLocalBounds().toFloat());
 
     /*auto bounds = getLocalBounds();
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * 0.33);*/
@@ -507,82 +1541,24 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     // even smaller
     auto responseArea = getAnalysisArea();
 
-    auto w = responseArea.getWidth(); // w : int 
-
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
-
-    auto sampleRate = audioProcessor.getSampleRate();
-
-    std::vector<double> mags;   // magnitude
-
-    mags.resize(w);
-
-    for (int i = 0; i < w; ++i)
-    {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-
-        if (!monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        if ( !monoChain.isBypassed<ChainPositions::LowCut>() )
-        {
-            if (!lowcut.isBypassed<0>())
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<1>())
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<2>())
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<3>())
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        if ( !monoChain.isBypassed<ChainPositions::HighCut>() )
-        {
-            if (!highcut.isBypassed<0>())
-                mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<1>())
-                mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<2>())
-                mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<3>())
-                mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        mags[i] = Decibels::gainToDecibels(mag);
-    }
-
-    Path responseCurve; // Juce::Path
-
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    auto map = [outputMin, outputMax](double input)
-    {
-        return jmap(input, -24.0, 24.0, outputMin, outputMax);
-    };
-
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
-
-    for (size_t i = 1; i < mags.size(); ++i)
-    {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-    }
+    // the response curve (responseCurve) is cached, see updateResponseCurve()
 
     // draw FFTcurve before we draw our rendered area
-    if ( shouldshowFFTAnalysis )
+    if ( shouldshowFFTAnalysis && ! usingOpenGL )
     {
-        // left Channel
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-        g.setColour(Colours::skyblue);
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
-        // Right Channel
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-        g.setColour(Colours::lightyellow);
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        const auto showMidSide = getAnalyzerChannels() == AnalyzerChannels::MidSide;
+
+        // the paths are in analysis area coordinates: stroked in place with a transform, no copy
+        const auto toResponseArea = AffineTransform::translation((float)responseArea.getX(), (float)responseArea.getY());
+
+        // left Channel (or mid)
+        const auto& leftChannelFFTPath = showMidSide ? midPathProducer.getPath() : leftPathProducer.getPath();
+        g.setColour(showMidSide ? Colours::lightgreen : Colours::skyblue);
+        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f), toResponseArea);
+        // Right Channel (or side)
+        const auto& rightChannelFFTPath = showMidSide ? sidePathProducer.getPath() : rightPathProducer.getPath();
+        g.setColour(showMidSide ? Colours::orchid : Colours::lightyellow);
+        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f), toResponseArea);
     }
 
     // draw
@@ -603,9 +1579,26 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
 void ResponseCurveComponent::resized()
 {
     using namespace juce;
-    background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
 
-    Graphics g(background);
+    // the analyzer thread draws its paths into this area
+    analysisBoundsSlot.push(getAnalysisArea().toFloat());
+
+    // new width: every band has to be evaluated again
+    bandNeedsUpdate.fill(true);
+    updateResponseCurve();
+
+    // the GL viewport and the trace positions follow our size
+    pushGLFrame();
+
+    // the grid for the new size comes from the shared cache on the next paint()
+    background = Image();
+}
+
+// the grid, the frequency and the gain labels, in component coordinates
+// only called by BackgroundImageCache, once per size and scale for the whole process
+void ResponseCurveComponent::drawBackground(juce::Graphics& g)
+{
+    using namespace juce;
 
     // Horizontal axis value(frequency)
     Array<float> freqs
@@ -771,7 +1764,16 @@ highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlope
 lowCutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypassed", lowCutBypassButton),
 peakBypassButtonAttachment(audioProcessor.apvts, "Peak Bypassed", peakBypassButton),
 highCutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypassed", highCutBypassButton),
-analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton)
+analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton),
+
+analyzerFFTOrderBox(*audioProcessor.apvts.getParameter("Analyzer FFT Order")),
+analyzerModeBox(*audioProcessor.apvts.getParameter("Analyzer Mode")),
+analyzerChannelsBox(*audioProcessor.apvts.getParameter("Analyzer Channels")),
+analyzerRendererBox(*audioProcessor.apvts.getParameter("Analyzer Renderer")),
+analyzerFFTOrderBoxAttachment(audioProcessor.apvts, "Analyzer FFT Order", analyzerFFTOrderBox),
+analyzerModeBoxAttachment(audioProcessor.apvts, "Analyzer Mode", analyzerModeBox),
+analyzerChannelsBoxAttachment(audioProcessor.apvts, "Analyzer Channels", analyzerChannelsBox),
+analyzerRendererBoxAttachment(audioProcessor.apvts, "Analyzer Renderer", analyzerRendererBox)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -975,6 +1977,12 @@ void SimpleEQAudioProcessorEditor::resized()
 
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
 
+    // the FFT size next to it
+    analyzerFFTOrderBox.setBounds(analyzerEnabledArea.withX(analyzerEnabledArea.getRight() + 5).withWidth(80));
+    analyzerModeBox.setBounds(analyzerFFTOrderBox.getBounds().withX(analyzerFFTOrderBox.getRight() + 5).withWidth(100));
+    analyzerChannelsBox.setBounds(analyzerModeBox.getBounds().withX(analyzerModeBox.getRight() + 5).withWidth(100));
+    analyzerRendererBox.setBounds(analyzerChannelsBox.getBounds().withX(analyzerChannelsBox.getRight() + 5).withWidth(70));
+
     bounds.removeFromTop(5);
 
     float hRatio = 25.f / 100.f; //JUCE_LIVE_CONSTANT(33) / 100.f;
@@ -1022,6 +2030,10 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
         &lowCutBypassButton, 
         &peakBypassButton, 
         &highCutBypassButton, 
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+        &analyzerFFTOrderBox,
+        &analyzerModeBox,
+        &analyzerChannelsBox,
+        &analyzerRendererBox
     };
 }
@@ -11,6 +11,9 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+#include <functional>
+#include <list>
+
 /********************************* my code here ***************************************/
 
 // FFT Generator
@@ -21,9 +24,275 @@ enum FFTOrder
     order8192 = 13
 };
 
+/*
+ log2 for the analyzer: exponent straight from the float bits + a 5th order polynomial for the mantissa.
+ max error ~1.7e-5 (about 0.0001 dB), good for positive finite values.
+ zero and denormals come out around -127, i.e. way below any dB floor we clamp to.
+ */
+// juce_dsp includes <immintrin.h> / <arm_neon.h> (and defines __SSE2__ for x64 MSVC)
+#if JUCE_USE_SIMD && defined (__SSE2__)
+ #define SIMPLEEQ_SSE2 1
+#elif JUCE_USE_SIMD && (defined (__ARM_NEON__) || defined (__ARM_NEON) || defined (_M_ARM64))
+ #define SIMPLEEQ_NEON 1
+#endif
+
+namespace FastLog2
+{
+    // log2(1 + t) for t in [0, 1): t * (c0 + t * (c1 + t * (c2 + t * (c3 + t * c4))))
+    constexpr float c0 = 1.4418799f, c1 = -0.708865218f, c2 = 0.41524556f, c3 = -0.193516524f, c4 = 0.0452682925f;
+
+    constexpr uint32_t mantissaMask = 0x007fffffu;
+    constexpr uint32_t exponentMask = 0x7f800000u; // all ones for inf and nan
+    constexpr uint32_t oneBits = 0x3f800000u;      // 1.f
+}
+
+inline float fastLog2(float x) noexcept
+{
+    using namespace FastLog2;
+
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    const auto exponent = (float)((int)(bits >> 23) - 127);
+
+    // mantissa in [1, 2)
+    bits = (bits & mantissaMask) | oneBits;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    const auto t = mantissa - 1.f;
+    return exponent + t * (c0 + t * (c1 + t * (c2 + t * (c3 + t * c4))));
+}
+
+/*
+ FFT magnitudes -> dB, in place:
+ v / numBins, inf/nan -> negativeInfinity, then the same result as juce::Decibels::gainToDecibels.
+ 20 * log10(v / numBins) == 20 * log10(2) * (log2(v) - log2(numBins))
+ written with SSE2 / NEON intrinsics, 4 bins at a time: the compilers don't vectorise the
+ finite check + clamp on their own without -ffast-math (the scalar loop has control flow)
+ the finite check looks at the exponent bits, so it's a mask and no branch
+ */
+inline void magnitudesToDecibels(float* data, int numBins, float negativeInfinity) noexcept
+{
+    using namespace FastLog2;
+
+    constexpr float decibelsPerOctave = 6.02059991f;
+    const auto log2NumBins = std::log2((float)numBins);
+    int i = 0;
+
+   #if SIMPLEEQ_SSE2
+    const auto vMantissaMask = _mm_set1_epi32((int)mantissaMask);
+    const auto vExponentMask = _mm_set1_epi32((int)exponentMask);
+    const auto vOneBits = _mm_set1_epi32((int)oneBits);
+    const auto vExponentBias = _mm_set1_epi32(127);
+    const auto vOne = _mm_set1_ps(1.f);
+    const auto vLog2NumBins = _mm_set1_ps(log2NumBins);
+    const auto vDecibelsPerOctave = _mm_set1_ps(decibelsPerOctave);
+    const auto vNegativeInfinity = _mm_set1_ps(negativeInfinity);
+
+    for (; i + 4 <= numBins; i += 4)
+    {
+        const auto bits = _mm_castps_si128(_mm_loadu_ps(data + i));
+
+        const auto exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), vExponentBias));
+        const auto t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, vMantissaMask), vOneBits)), vOne);
+
+        auto polynomial = _mm_add_ps(_mm_set1_ps(c3), _mm_mul_ps(t, _mm_set1_ps(c4)));
+        polynomial = _mm_add_ps(_mm_set1_ps(c2), _mm_mul_ps(t, polynomial));
+        polynomial = _mm_add_ps(_mm_set1_ps(c1), _mm_mul_ps(t, polynomial));
+        polynomial = _mm_add_ps(_mm_set1_ps(c0), _mm_mul_ps(t, polynomial));
+        const auto log2 = _mm_add_ps(exponent, _mm_mul_ps(t, polynomial));
+
+        const auto dB = _mm_max_ps(_mm_mul_ps(vDecibelsPerOctave, _mm_sub_ps(log2, vLog2NumBins)), vNegativeInfinity);
+
+        // all ones where the exponent isn't all ones (finite), a signed compare is fine below 0x7f800000
+        const auto isFinite = _mm_castsi128_ps(_mm_cmplt_epi32(_mm_and_si128(bits, vExponentMask), vExponentMask));
+        _mm_storeu_ps(data + i, _mm_or_ps(_mm_and_ps(isFinite, dB), _mm_andnot_ps(isFinite, vNegativeInfinity)));
+    }
+   #elif SIMPLEEQ_NEON
+    const auto vMantissaMask = vdupq_n_u32(mantissaMask);
+    const auto vExponentMask = vdupq_n_u32(exponentMask);
+    const auto vOneBits = vdupq_n_u32(oneBits);
+    const auto vExponentBias = vdupq_n_s32(127);
+    const auto vOne = vdupq_n_f32(1.f);
+    const auto vLog2NumBins = vdupq_n_f32(log2NumBins);
+    const auto vDecibelsPerOctave = vdupq_n_f32(decibelsPerOctave);
+    const auto vNegativeInfinity = vdupq_n_f32(negativeInfinity);
+
+    for (; i + 4 <= numBins; i += 4)
+    {
+        const auto bits = vreinterpretq_u32_f32(vld1q_f32(data + i));
+
+        const auto exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vExponentBias));
+        const auto t = vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vMantissaMask), vOneBits)), vOne);
+
+        // vmlaq_f32(a, b, c) = a + b * c
+        auto polynomial = vmlaq_f32(vdupq_n_f32(c3), t, vdupq_n_f32(c4));
+        polynomial = vmlaq_f32(vdupq_n_f32(c2), t, polynomial);
+        polynomial = vmlaq_f32(vdupq_n_f32(c1), t, polynomial);
+        polynomial = vmlaq_f32(vdupq_n_f32(c0), t, polynomial);
+        const auto log2 = vmlaq_f32(exponent, t, polynomial);
+
+        const auto dB = vmaxq_f32(vmulq_f32(vDecibelsPerOctave, vsubq_f32(log2, vLog2NumBins)), vNegativeInfinity);
+
+        const auto isFinite = vcltq_u32(vandq_u32(bits, vExponentMask), vExponentMask);
+        vst1q_f32(data + i, vbslq_f32(isFinite, dB, vNegativeInfinity));
+    }
+   #endif
+
+    // the last few bins (or everything, without SSE / NEON): same maths, one at a time
+    for (; i < numBins; ++i)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+
+        const auto dB = juce::jmax(decibelsPerOctave * (fastLog2(data[i]) - log2NumBins), negativeInfinity);
+        data[i] = (bits & exponentMask) != exponentMask ? dB : negativeInfinity;
+    }
+}
+
+// the FFT plans and windows for every order, made once, up front
+// one set is shared by all the FFTDataGenerators of an editor (they all run on the analyzer thread)
+struct FFTPlans
+{
+    static constexpr int numOrders = 3;
+    static constexpr int maxFFTSize = 1 << FFTOrder::order8192;
+
+    FFTPlans()
+    {
+        for (int i = 0; i < numOrders; ++i)
+        {
+            const auto orderToMake = FFTOrder::order2048 + i;
+            forwardFFTs[i] = std::make_unique<juce::dsp::FFT>(orderToMake);
+            windows[i] = std::make_unique<juce::dsp::WindowingFunction<float>>(1 << orderToMake, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        }
+    }
+
+    static int getIndex(FFTOrder order) { return order - FFTOrder::order2048; }
+
+    const juce::dsp::FFT& getFFT(FFTOrder order) const { return *forwardFFTs[getIndex(order)]; }
+    const juce::dsp::WindowingFunction<float>& getWindow(FFTOrder order) const { return *windows[getIndex(order)]; }
+
+    // the small FFT every level of the MultiResolutionAnalyzer uses
+    static constexpr int multiResolutionOrder = 9;
+    const juce::dsp::FFT& getMultiResolutionFFT() const { return multiResolutionFFT; }
+    const juce::dsp::WindowingFunction<float>& getMultiResolutionWindow() const { return multiResolutionWindow; }
+private:
+    std::array<std::unique_ptr<juce::dsp::FFT>, numOrders> forwardFFTs;
+    std::array<std::unique_ptr<juce::dsp::WindowingFunction<float>>, numOrders> windows;
+
+    juce::dsp::FFT multiResolutionFFT{ multiResolutionOrder };
+    juce::dsp::WindowingFunction<float> multiResolutionWindow{ 1 << multiResolutionOrder, juce::dsp::WindowingFunction<float>::blackmanHarris };
+};
+
+/*
+ multi-resolution analyzer
+ the same 512 point FFT runs on the audio and on copies of it decimated by 2, 4, 8, ...
+ level k runs at sampleRate / 2^k and only shows the octave [fs_k / 12, fs_k / 6]
+ (level 0 shows everything above fs / 12, the last level everything below its octave)
+ so every octave gets ~43 bins: 1Hz-ish bins in the lows, no wasted bins in the highs
+ about 9 levels for 20Hz..20kHz at 48kHz
+
+ cost: a 512 FFT every 512 samples of each level (every 1024 samples at level 0)
+ plus an 11 tap half-band per decimation, a bit less than a 2048 FFT every 1024 samples.
+ the low levels have long windows (2.7s at level 8 @ 48kHz), that's the price of the resolution.
+
+ everything runs on the analyzer thread, everything is allocated in the constructor
+ (apart from the column table, when the width changes)
+ */
+struct MultiResolutionAnalyzer
+{
+    static constexpr int maxNumLevels = 12;
+    static constexpr int fftSize = 1 << FFTPlans::multiResolutionOrder;
+    static constexpr int numBins = fftSize / 2;
+
+    MultiResolutionAnalyzer(const FFTPlans& plans);
+
+    // picks the number of levels for this rate, forgets all the audio and spectra
+    void prepare(double sampleRate, float negativeInfinity);
+    // the next samples don't follow on from the last ones (a gap in the capture)
+    void restartLevels();
+
+    void addSamples(const float* samples, int numSamples, float negativeInfinity);
+
+    // true once after one or more levels made a new spectrum
+    // 'elapsedSamples' = input samples since the last call that returned true
+    bool pullNewSpectra(int& elapsedSamples);
+
+    // one dB value per pixel column of the 20Hz..20kHz log axis
+    void renderColumns(std::vector<float>& columnLevels, int numColumns);
+private:
+    // 2:1 decimation, 11 tap half-band (Kaiser, beta 5)
+    // passband to fs / 12 (-0.02dB), images from above 5fs / 12 down by 54dB
+    // that's all the headroom the -48dB floor needs, and only 4 multiplies per output
+    struct HalfBandDecimator
+    {
+        static constexpr int numTaps = 11;
+
+        HalfBandDecimator();
+        void reset();
+        int process(const float* input, int numSamples, float* output);
+    private:
+        std::array<float, numTaps> coefficients;
+        std::array<float, numTaps * 2> history; // every sample is written twice, the window is always contiguous
+        int historyIndex = 0;
+        bool isOddSample = false;
+    };
+
+    struct Level
+    {
+        HalfBandDecimator decimator; // feeds the next level
+        std::vector<float> ring;
+        std::vector<float> spectrum; // dB, numBins
+        int ringWriteIndex = 0;
+        int samplesSinceGap = 0;
+        int samplesUntilNextFFT = fftSize;
+        int hopSize = fftSize;
+    };
+
+    void feedLevel(int levelIndex, const float* samples, int numSamples, float negativeInfinity);
+    void renderLevel(Level& level, float negativeInfinity);
+
+    const FFTPlans& plans;
+    std::array<Level, maxNumLevels> levels;
+    int numLevels = 1;
+    double sampleRate = 0.0;
+
+    std::vector<float> fftData;
+
+    // the audio goes through in chunks, so the decimated copies fit in these
+    static constexpr int chunkSize = 256;
+    std::array<std::vector<float>, maxNumLevels> decimatedChunks;
+
+    bool hasNewSpectra = false;
+    int samplesSinceLastPull = 0;
+
+    // per pixel column: the level, and either a range of bins (max)
+    // or, if the column is narrower than a bin, a fractional bin (interpolated)
+    struct ColumnBins
+    {
+        int level = 0;
+        int firstBin = 0;
+        int lastBin = 0;
+        float fraction = -1.f;
+    };
+    std::vector<ColumnBins> columnTable;
+    double columnTableSampleRate = 0.0;
+    void updateColumnTable(int numColumns);
+};
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
+    FFTDataGenerator(const FFTPlans& plansToUse) :
+    plans(plansToUse)
+    {
+        // fftData and the fifo are sized for the biggest order
+        // so changeOrder() never allocates
+        fftData.resize(FFTPlans::maxFFTSize * 2, 0);
+        fftDataFifo.prepare(fftData.size());
+    }
+
     /**
      produces the FFT data from an audio buffer.
      */
@@ -31,41 +300,48 @@ struct FFTDataGenerator
     {
         const auto fftSize = getFFTSize();
 
-        fftData.assign(fftData.size(), 0);
+        // no need to clear fftData: the first fftSize values are overwritten here
+        // and the FFT only reads those (the upper half is its output/scratch space)
         auto* readIndex = audioData.getReadPointer(0);
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
 
+        renderFFTData(negativeInfinity);
+    }
+
+    /**
+     same thing, straight from a circular buffer of getFFTSize() samples
+     whose oldest sample is at 'oldestIndex' (no need to shift the buffer first).
+     */
+    void produceFFTDataForRendering(const float* ring, int oldestIndex, const float negativeInfinity)
+    {
+        const auto fftSize = getFFTSize();
+        jassert(juce::isPositiveAndBelow(oldestIndex, fftSize));
+
+        std::copy(ring + oldestIndex, ring + fftSize, fftData.begin());
+        std::copy(ring, ring + oldestIndex, fftData.begin() + (fftSize - oldestIndex));
+
+        renderFFTData(negativeInfinity);
+    }
+
+    void renderFFTData(const float negativeInfinity)
+    {
+        const auto fftSize = getFFTSize();
+
         // first apply a windowing function to our data
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);       // [1]
+        plans.getWindow(order).multiplyWithWindowingTable(fftData.data(), fftSize);       // [1]
 
         // then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());  // [2]
+        plans.getFFT(order).performFrequencyOnlyForwardTransform(fftData.data());  // [2]
 
         int numBins = (int)fftSize / 2;
 
-        //normalize the fft values.
-        for (int i = 0; i < numBins; ++i)
-        {
-            auto v = fftData[i];
-            //            fftData[i] /= (float) numBins;
-            if (!std::isinf(v) && !std::isnan(v))
-            {
-                v /= float(numBins);
-            }
-            else
-            {
-                v = 0.f;
-            }
-            fftData[i] = v;
-        }
-
-        //convert them to decibels
-        for (int i = 0; i < numBins; ++i)
-        {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
+        //normalize the fft values, throw away inf/nan and convert them to decibels, all in one pass
+        magnitudesToDecibels(fftData.data(), numBins, negativeInfinity);
 
-        fftDataFifo.push(fftData);
+        // fftData and the fifo's slots all have the same size, so just swap
+        // the fifo holds one frame: it has to be read before the next one is made
+        const auto pushed = fftDataFifo.pushBySwapping(fftData);
+        jassertquiet(pushed);
     }
 
     void changeOrder(FFTOrder newOrder)
@@ -73,38 +349,85 @@ struct FFTDataGenerator
         //when you change order, recreate the window, forwardFFT, fifo, fftData
         //also reset the fifoIndex
         //things that need recreating should be created on the heap via std::make_unique<>
+        // not anymore: everything was made in the constructor, we only switch to it
+        // call this from the thread that reads the FFT data (blocks of the old order are thrown away)
 
         order = newOrder;
-        auto fftSize = getFFTSize();
-
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
-
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
 
-        fftDataFifo.prepare(fftData.size());
+        while ( fftDataFifo.pullInPlace([](BlockType&) { }) ) { }
     }
     //==============================================================================
+    FFTOrder getOrder() const { return order; }
     int getFFTSize() const { return 1 << order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
     bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    // zero-copy version: calls 'callback' with the oldest FFT data block, straight out of the fifo
+    template<typename Callback>
+    bool readFFTData(Callback&& callback) { return fftDataFifo.pullInPlace(std::forward<Callback>(callback)); }
 private:
-    FFTOrder order;
+    FFTOrder order = FFTOrder::order2048;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    const FFTPlans& plans;
 
-    Fifo<BlockType> fftDataFifo;
+    // one frame: the reader takes every frame right after it's made (see PathProducer::addSamples)
+    // a second frame made before that would be dropped
+    // the fifo has two slots of 2 * maxFFTSize floats (64kB each), see Fifo
+    Fifo<BlockType, 1> fftDataFifo;
 };
 
 
 // turn blocks into a path
 // let's write a path generator class
+// what the analyzer draws: the latest frame, an exponential average,
+// peaks that fall back at 'peakDecay' dB/s, or the max since the last reset
+enum AnalyzerMode
+{
+    Latest,
+    Average,
+    PeakHold,
+    MaxHold
+};
+
+/*
+ runs on every FFT frame (dB bins), before the path is made
+ all the state lives in one array that is allocated in prepare()
+ */
+struct SpectrumAverager
+{
+    void prepare(int maxNumBins);
+    void reset();
+
+    void setMode(AnalyzerMode newMode);
+    void setAveragingTime(float seconds);      // Average: time constant
+    void setPeakDecay(float decibelsPerSecond); // PeakHold: how fast the peaks fall back
+
+    // 'frameSeconds' = time between two frames (hop size / sample rate)
+    void addFrame(const std::vector<float>& frame, int numBins, double frameSeconds);
+
+    // what to draw, valid up to the numBins of the last frame
+    const std::vector<float>& getLevels() const { return levels; }
+private:
+    AnalyzerMode mode = AnalyzerMode::Latest;
+    float averagingTime = 0.5f;
+    float peakDecay = 20.f;
+
+    std::vector<float> levels;
+    bool isEmpty = true;
+};
+
 template<typename PathType>
 struct AnalyzerPathGenerator
 {
+    // what goes through the fifo: the path for the software renderer, and the same points
+    // for the OpenGL one, already as a triangle strip down to the bottom of the fft bounds:
+    // x, y, x, bottom for every point (the trace itself is every other vertex)
+    struct Output
+    {
+        PathType path;
+        std::vector<float> fillStrip;
+    };
+
     /*
      converts 'renderData[]' into a juce::Path
      */
@@ -120,8 +443,12 @@ struct AnalyzerPathGenerator
 
         int numBins = (int)fftSize / 2;
 
-        PathType p;
+        // reuse the same output (clear() keeps the storage)
+        // it's swapped into the fifo below, and gets an older one back
+        auto& p = output.path;
+        p.clear();
         p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        startFillStrip((int)fftBounds.getWidth());
 
         auto map = [bottom, top, negativeInfinity](float v)
         {
@@ -137,25 +464,80 @@ struct AnalyzerPathGenerator
             y = bottom;
 
         p.startNewSubPath(0, y);
+        addToFillStrip(0.f, y, bottom);
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+        // the logs only happen when the size / sample rate changes
+        updateBinToColumnTable(numBins, (int)width, binWidth);
 
-        for (int binNum = 1; binNum < numBins; binNum += pathResolution)
+        // several bins land on the same pixel column in the highs: keep the loudest one
+        // (columnLevels starts at -inf, which means 'no bin here', e.g. the lows at big widths)
+        std::fill(columnLevels.begin(), columnLevels.end(), -std::numeric_limits<float>::infinity());
+
+        for (int binNum = 1; binNum < numBins; ++binNum)
         {
-            y = map(renderData[binNum]);
+            const auto column = binToColumn[binNum];
+            if ( column >= 0 )
+                columnLevels[column] = juce::jmax(columnLevels[column], renderData[binNum]);
+        }
+
+        // at most one point per pixel column, whatever the FFT size
+        for (int column = 0; column < (int)columnLevels.size(); ++column)
+        {
+            y = map(columnLevels[column]);
 
             //jassert( !std::isnan(y) && !std::isinf(y) );
 
             if (!std::isnan(y) && !std::isinf(y))
             {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                p.lineTo(column, y);
+                addToFillStrip((float)column, y, bottom);
             }
         }
 
-        pathFifo.push(p);
+        pathFifo.pushBySwapping(output);
+    }
+
+    /*
+     same thing for data that is already one value per pixel column (MultiResolutionAnalyzer)
+     */
+    void generatePathFromColumns(const std::vector<float>& columnLevels,
+                                 int numColumns,
+                                 juce::Rectangle<float> fftBounds,
+                                 float negativeInfinity)
+    {
+        auto top = fftBounds.getY();
+        auto bottom = fftBounds.getHeight();
+
+        auto& p = output.path;
+        p.clear();
+        p.preallocateSpace(3 * numColumns);
+        startFillStrip(numColumns);
+
+        auto map = [bottom, top, negativeInfinity](float v)
+        {
+            return juce::jmap(v,
+                              negativeInfinity, 0.f,
+                              float(bottom), top);
+        };
+
+        bool started = false;
+        for (int column = 0; column < numColumns; ++column)
+        {
+            auto y = map(columnLevels[column]);
+
+            if (std::isnan(y) || std::isinf(y))
+                continue;
+
+            if ( started )
+                p.lineTo(column, y);
+            else
+                p.startNewSubPath(column, y);
+
+            addToFillStrip((float)column, y, bottom);
+            started = true;
+        }
+
+        pathFifo.pushBySwapping(output);
     }
 
     int getNumPathsAvailable() const
@@ -163,12 +545,53 @@ struct AnalyzerPathGenerator
         return pathFifo.getNumAvailableForReading();
     }
 
-    bool getPath(PathType& path)
+    // swaps: 'result' gets the oldest output, the fifo gets whatever 'result' held
+    bool getOutput(Output& result)
     {
-        return pathFifo.pull(path);
+        return pathFifo.pullBySwapping(result);
     }
 private:
-    Fifo<PathType> pathFifo;
+    Fifo<Output> pathFifo;
+    Output output;
+
+    void startFillStrip(int maxNumPoints)
+    {
+        output.fillStrip.clear();
+        output.fillStrip.reserve(4 * (size_t)juce::jmax(0, maxNumPoints + 1));
+    }
+
+    void addToFillStrip(float x, float y, float bottom)
+    {
+        output.fillStrip.insert(output.fillStrip.end(), { x, y, x, bottom });
+    }
+
+    // binToColumn[bin] = pixel column of that bin on the 20Hz..20kHz log axis, -1 if it's off screen
+    std::vector<int> binToColumn;
+    std::vector<float> columnLevels;
+    int tableNumBins = 0, tableWidth = 0;
+    float tableBinWidth = 0.f;
+
+    void updateBinToColumnTable(int numBins, int width, float binWidth)
+    {
+        if ( numBins == tableNumBins && width == tableWidth && binWidth == tableBinWidth )
+            return;
+
+        tableNumBins = numBins;
+        tableWidth = width;
+        tableBinWidth = binWidth;
+
+        binToColumn.resize(numBins);
+        columnLevels.resize(juce::jmax(0, width));
+
+        binToColumn[0] = -1; // DC, it's the start of the path
+        for (int binNum = 1; binNum < numBins; ++binNum)
+        {
+            auto binFreq = binNum * binWidth;
+            auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
+            int binX = std::floor(normalizedBinX * width);
+            binToColumn[binNum] = juce::isPositiveAndBelow(binX, width) ? binX : -1;
+        }
+    }
 };
 
 
@@ -240,29 +663,253 @@ private:
 };
 
 
+// time spent per frame on one thread, in milliseconds
+// written by the thread being measured, readable from anywhere
+struct FrameTimeMetric
+{
+    // adds the lifetime of this object to the frame being measured
+    struct ScopedTimer
+    {
+        ScopedTimer(FrameTimeMetric& m) : metric(m), startTicks(juce::Time::getHighResolutionTicks()) { }
+        ~ScopedTimer()
+        {
+            metric.addTime(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0);
+        }
+    private:
+        FrameTimeMetric& metric;
+        juce::int64 startTicks;
+    };
+
+    void addTime(double milliseconds) { currentFrameMs += milliseconds; }
+
+    // closes the current frame (once per frame)
+    void endFrame()
+    {
+        lastFrameMs.store(currentFrameMs);
+        averageFrameMs.store(averageFrameMs.load() + 0.05 * (currentFrameMs - averageFrameMs.load()));
+        currentFrameMs = 0.0;
+    }
+
+    double getLastFrameMilliseconds() const { return lastFrameMs.load(); }
+    double getAverageFrameMilliseconds() const { return averageFrameMs.load(); }
+private:
+    double currentFrameMs = 0.0;    // only touched by the measured thread
+    std::atomic<double> lastFrameMs{ 0.0 }, averageFrameMs{ 0.0 };
+};
+
+// the analyzer's own thread
+// runs the callback (drain the capture fifo, FFTs, paths) about 60 times a second
+// so none of that work happens on the message thread
+struct AnalyzerThread : juce::Thread
+{
+    AnalyzerThread(std::function<void()> analyseCallback) :
+    juce::Thread("SimpleEQ analyzer"),
+    analyse(std::move(analyseCallback))
+    {
+    }
+
+    ~AnalyzerThread() override { stopThread(1000); }
+
+    void run() override
+    {
+        while ( ! threadShouldExit() )
+        {
+            {
+                FrameTimeMetric::ScopedTimer timer(frameTime);
+                analyse();
+            }
+            frameTime.endFrame();
+
+            wait(frameIntervalMs);
+        }
+    }
+
+    const FrameTimeMetric& getFrameTime() const { return frameTime; }
+private:
+    std::function<void()> analyse;
+    FrameTimeMetric frameTime;
+
+    static constexpr int frameIntervalMs = 16;
+};
+
 struct PathProducer
 {
-    PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>& scsf) :
-    leftChannelFifo(&scsf)
+    using CapturedBlock = MultiChannelSampleFifo<SimpleEQAudioProcessor::BlockType>::CapturedBlock;
+
+    // a producer doesn't know which channel it draws: the reader of the capture fifo hands it the samples
+    // (a captured channel, or something derived from them like mid / side)
+    PathProducer(const FFTPlans& plans) :
+    leftChannelFFTDataGenerator(plans),
+    multiResolutionAnalyzer(plans)
     {
+        // allocate the ring for the biggest FFT, then use as much of it as the current order needs
+        monoBuffer.setSize(1, FFTPlans::maxFFTSize);
         leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize(), false, true, true);
+        monoBuffer.clear();
+
+        averager.prepare(FFTPlans::maxFFTSize / 2);
+        multiResolutionColumns.resize(FFTPlans::maxFFTSize / 2);
     }
+
+    // analyzer thread: switches the FFT size (no allocation), the window is filled again from scratch
+    void changeOrder(FFTOrder newOrder);
+    // the capture fifo has a single reader, which hands every block to the path producers on show
+    // addSamples() and process() run on the analyzer thread
+    // 'position' = the capture position of the first sample
+    void addSamples(const float* samples, int numSamples, juce::int64 position);
     void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() { return leftChannelFFTPath; }
-private:
-    SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>* leftChannelFifo;
 
+    // message thread: swap in the newest finished path, and draw it
+    // returns false if nothing new came in (no need to repaint)
+    bool pullLatestPath();
+    // message thread: forget the paths made before the analyzer was switched off
+    void clearPaths();
+    // message thread: the latest path, and the same points as a fill strip for the OpenGL renderer
+    // (see AnalyzerPathGenerator::Output), both in analysis area coordinates
+    const juce::Path& getPath() const { return latestOutput.path; }
+    const std::vector<float>& getFillStrip() const { return latestOutput.fillStrip; }
+
+    // how often an FFT is run, independent of the host block size
+    // either a fixed overlap between consecutive FFT windows (0.5 = 50%, 0.75 = 75%, ...)
+    // or a fixed number of FFTs per second (e.g. the repaint rate)
+    void setOverlap(float overlap);
+    void setFramesPerSecond(double framesPerSecond);
+
+    // analyzer thread: averaging / peak hold / max hold, see SpectrumAverager
+    // resetHold() starts the average and the held peaks again
+    void setMode(AnalyzerMode mode) { averager.setMode(mode); }
+    void resetHold() { averager.reset(); }
+
+    // analyzer thread: the MultiResolutionAnalyzer instead of one big FFT
+    void setMultiResolution(bool shouldUseMultiResolution, double sampleRate);
+private:
+    // circular: ringWriteIndex is where the next sample goes, i.e. the oldest sample
     juce::AudioBuffer<float> monoBuffer;
+    int ringWriteIndex = 0;
+
+    // samples between two FFTs
+    enum HopMode { FixedOverlap, FixedFrameRate };
+    HopMode hopMode = HopMode::FixedOverlap;
+    float overlap = 0.5f;
+    double framesPerSecond = 60.0;
+    int hopSize = 1024;
+    int samplesUntilNextFFT = 1024;
+    double frameSeconds = 1024.0 / 48000.0; // time between two FFTs
+    void updateHopSize(double sampleRate);
+
+    // gap detection: where the next block should start, and how much of monoBuffer is contiguous audio
+    juce::int64 nextBlockPosition = 0;
+    int samplesSinceGap = 0;
 
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
 
+    // every FFT frame goes into the averager right after it's made
+    // process() turns the result into a path if there was at least one
+    SpectrumAverager averager;
+    bool hasNewFrames = false;
+    void addFFTFrames();
+
+    bool useMultiResolution = false;
+    double multiResolutionSampleRate = 0.0;
+    MultiResolutionAnalyzer multiResolutionAnalyzer;
+    std::vector<float> multiResolutionColumns;
+    int numMultiResolutionColumns = 0;
+    void processMultiResolution(juce::Rectangle<float> fftBounds, double sampleRate);
+
     AnalyzerPathGenerator<juce::Path> pathProducer;
 
-    juce::Path leftChannelFFTPath;
+    AnalyzerPathGenerator<juce::Path>::Output latestOutput;
 };
 
 
+/*
+ the response curve's background (grid + labels) for every editor in the process
+ keyed by size and display scale: editors of the same size on the same screen share one image,
+ and the glyphs / getStringWidth() measurements only happen once per key
+ least recently used images go first once the cache holds more than maxBytes
+ message thread only, get it through juce::SharedResourcePointer
+ */
+struct BackgroundImageCache
+{
+    // draw paints in component coordinates, it's only called on a miss (already scaled)
+    juce::Image getImage(int width, int height, float scale,
+                         const std::function<void(juce::Graphics&)>& draw);
+
+    static constexpr size_t maxBytes = 16 * 1024 * 1024;
+private:
+    struct Entry
+    {
+        int width, height;
+        int scaleKey; // scale * 100, so 1.2499 and 1.25 are the same
+        juce::Image image;
+    };
+
+    std::list<Entry> entries; // front: most recently used
+    size_t totalBytes = 0;
+
+    static size_t getNumBytes(const juce::Image& image);
+};
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+/*
+ optional OpenGL backend for the analyzer (the "Analyzer Renderer" parameter)
+ the traces go to the GPU as vertex buffers: a line strip per trace plus a translucent fill down to the analysis bottom
+ the component still paints the grid, the labels, the border and the response curve, JUCE puts that on top of the GL layer
+ if GL can't be used (no context, shaders don't compile) hasFailed() goes true and the owner falls back to software
+ */
+struct AnalyzerGLRenderer : juce::OpenGLRenderer
+{
+    struct Trace
+    {
+        std::vector<float> fillStrip; // from PathProducer::getFillStrip(), in analysis area coordinates
+        juce::Colour colour;
+    };
+
+    // what the message thread hands over for one GL frame
+    struct Frame
+    {
+        std::array<Trace, 2> traces;
+        juce::Point<float> origin; // the analysis area's top left, in component coordinates
+        int width = 0, height = 0;
+    };
+
+    AnalyzerGLRenderer(juce::Component& componentToDrawOn);
+    ~AnalyzerGLRenderer() override;
+
+    // message thread: 'fill' writes every field of the frame (it gets whichever frame the slot has spare)
+    template<typename Callback>
+    void pushFrame(Callback&& fill)
+    {
+        frameSlot.pushInPlace(fill);
+        context.triggerRepaint();
+    }
+    bool hasFailed() const { return failed.load(); }
+    bool isActive() const { return context.isActive(); }
+
+    // GL thread
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
+private:
+    juce::OpenGLContext context;
+
+    std::unique_ptr<juce::OpenGLShaderProgram> shader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> viewSizeUniform, originUniform, colourUniform;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> positionAttribute;
+    juce::uint32 vertexBuffer = 0;
+
+    LatestValueSlot<Frame> frameSlot;
+    Frame frame; // GL thread
+
+    std::atomic<bool> failed{ false };
+
+    // from the buffer bound by renderOpenGL(), 'stride' in floats (0 = packed)
+    void drawVertices(juce::uint32 primitive, int numVertices, int stride, juce::Colour colour);
+};
+#endif
+
+
 // the components should not draw outside its bounds
 // so it(response area) should have its own components
 struct ResponseCurveComponent : juce::Component,
@@ -291,26 +938,61 @@ juce::Timer
 
     void timerCallback() override;
 
+    // double click: clears the averaged / held analyzer traces
+    void mouseDoubleClick(const juce::MouseEvent&) override { shouldResetAnalyzerHold = true; }
+
     void paint(juce::Graphics& g) override;
     void resized() override;
 
     void toggleAnalysisEnablement(bool enabled) 
     {
         shouldshowFFTAnalysis = enabled;
+        updateAnalyzerActivation();
+
+        // the traces appear / disappear
+        if ( enabled )
+            setTimerIdle(false);
+        pushGLFrame();
+        repaint();
     }
 
+    void visibilityChanged() override { updateAnalyzerActivation(); }
+
+    // how long a frame takes on the analyzer thread (FFTs + paths)
+    // and on the message thread (timer + paint)
+    const FrameTimeMetric& getAnalyzerFrameTime() const { return analyzerThread.getFrameTime(); }
+    const FrameTimeMetric& getMessageThreadFrameTime() const { return messageThreadFrameTime; }
+
 private:
     SimpleEQAudioProcessor& audioProcessor;
     
     // parameters changed flag
     juce::Atomic<bool> parametersChanged{ false };
 
-    MonoChain monoChain;
+    // the same design the audio thread runs, in double (it's only evaluated, never processed)
+    ChainCoefficients<double> chainCoefficients;
 
     void updateChain(); // refactor the code 
+
+    // the response curve only changes in updateChain() and resized(), so it's cached:
+    // one dB curve per band (ChainPositions, a value per pixel column of the analysis area), summed into the path
+    // a band is only evaluated again when its own settings (or the sample rate / width) change
+    static constexpr int numCurveBands = 3;
+    std::array<std::vector<double>, numCurveBands> bandMagnitudes;
+    std::array<bool, numCurveBands> bandNeedsUpdate{ true, true, true };
+    ChainSettings lastChainSettings;
+    double lastFilterSampleRate = 0.0;
+    juce::Path responseCurve;
+
+    FrequencyResponseEvaluator responseEvaluator;
+    void updateResponseCurve();
    
     // draw the grid's background
+    // shared with the other editors, see BackgroundImageCache
+    juce::SharedResourcePointer<BackgroundImageCache> backgroundCache;
     juce::Image background;
+    float backgroundScale = 0.f;
+    void drawBackground(juce::Graphics& g);
     juce::Rectangle<int> getRenderArea(); // don't want use getLocalBounds(), want smaller
     juce::Rectangle<int> getAnalysisArea(); // even smaller than getRenderArea()
 
@@ -320,14 +1002,73 @@ private:
     //FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
     //AnalyzerPathGenerator<juce::Path> pathProducer;
     //juce::Path leftChannelFFTPath;
+    FFTPlans fftPlans;
     PathProducer leftPathProducer, rightPathProducer;
 
-    bool shouldshowFFTAnalysis = true;
+    // "Analyzer Channels": Left / Right or Mid / Side (only the pair on show is analysed)
+    enum AnalyzerChannels { LeftRight, MidSide };
+    AnalyzerChannels getAnalyzerChannels() const;
+    PathProducer midPathProducer, sidePathProducer;
+    juce::AudioBuffer<float> midSideBuffer; // analyzer thread
+    // analyzer thread: one captured block to the pair on show
+    void addLeftRightBlock(const PathProducer::CapturedBlock& block);
+    void addMidSideBlock(const PathProducer::CapturedBlock& block);
+
+    // read by the analyzer thread too
+    std::atomic<bool> shouldshowFFTAnalysis{ true };
+    std::atomic<bool> shouldResetAnalyzerHold{ false };
+
+    // the processor only captures audio while we're reading it (see SimpleEQAudioProcessor::addAnalyzerReader())
+    // we read while the analyzer is on and we're on screen
+    bool isAnalyzerReader = false;
+    void updateAnalyzerActivation();
+
+    // while there's nothing to animate (analyzer off, no parameter moving) the timer drops to
+    // idleTimerHz, only polling parametersChanged (which can be set on the audio thread)
+    static constexpr int activeTimerHz = 60, idleTimerHz = 5;
+    bool timerIsIdle = false;
+    void setTimerIdle(bool shouldBeIdle);
+    // set when we start reading again: what's left in the capture fifo is old
+    std::atomic<bool> shouldFlushCapture{ false };
+
+    // analyzer thread side
+    // the analysis area is handed over from resized()
+    LatestValueSlot<juce::Rectangle<float>> analysisBoundsSlot;
+    juce::Rectangle<float> analysisBounds;
+    void runAnalysis();
+
+    FrameTimeMetric messageThreadFrameTime;
+
+    // "Analyzer Renderer": software (paint()) or OpenGL (AnalyzerGLRenderer)
+    // OpenGL falls back to software if it doesn't work, until the parameter is set again
+    bool isUsingOpenGL() const;
+    bool isWaitingForOpenGL() const;
+    void updateRenderer();
+    void pushGLFrame();
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    std::unique_ptr<AnalyzerGLRenderer> glRenderer;
+    int glTicksWithoutContext = 0;
+    bool glUnavailable = false;
+#endif
+
+    // last member: stopped before anything it uses goes away
+    AnalyzerThread analyzerThread{ [this] { runAnalysis(); } };
 
 };
 
 
 struct PowerButton : juce::ToggleButton { };
+
+// a combo box for a choice parameter (analyzer FFT size, analyzer mode)
+// the items come from the parameter, so they exist before the attachment is made
+struct ChoiceComboBox : juce::ComboBox
+{
+    ChoiceComboBox(juce::RangedAudioParameter& rap)
+    {
+        if ( auto* choice = dynamic_cast<juce::AudioParameterChoice*>(&rap) )
+            addItemList(choice->choices, 1);
+    }
+};
 struct AnalyzerButton : juce::ToggleButton 
 {
     void resized() override
@@ -405,6 +1146,13 @@ private:
                      highCutBypassButtonAttachment, 
                      analyzerEnabledButtonAttachment;
 
+    // analyzer FFT size, the box has to exist before its attachment
+    ChoiceComboBox analyzerFFTOrderBox, analyzerModeBox, analyzerChannelsBox, analyzerRendererBox;
+    APVTS::ComboBoxAttachment analyzerFFTOrderBoxAttachment,
+                              analyzerModeBoxAttachment,
+                              analyzerChannelsBoxAttachment,
+                              analyzerRendererBoxAttachment;
+
     std::vector<juce::Component*> getComps();
 
     LookAndFeel lnf;
@@ -22,10 +22,17 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    // a new topology / oversampling setting needs new chains and changes the latency, see handleAsyncUpdate()
+    for (auto* parameterID : engineParameterIDs)
+        apvts.addParameterListener(parameterID, this);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for (auto* parameterID : engineParameterIDs)
+        apvts.removeParameterListener(parameterID, this);
+
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -63,7 +70,9 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // the IIR tails are left to the host as usual
+    // but with oversampling the half-band filters still hold (latency) samples when the input stops
+    return tailLengthSeconds;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -97,24 +106,16 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // initialisation that you need..
 
     /*********************** my code here ************************************/
-    juce::dsp::ProcessSpec spec;
-
-    spec.maximumBlockSize = samplesPerBlock;
+    preparedSampleRate = sampleRate;
+    preparedBlockSize = samplesPerBlock;
 
-    spec.numChannels = 1;
+    readEngineSettings();
+    prepareEngine(sampleRate, samplesPerBlock);
 
-    spec.sampleRate = sampleRate;
-
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    
-    // Initial settings
-    
-    updateFilters();
-
-    // the single channel fifos need to prepared
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    // the capture fifo needs to prepared
+    // its blocks are sized by time, not by the host block size (see getBlockSizeFor())
+    captureFifo.prepare(juce::jlimit(1, maxNumCaptureChannels, getTotalNumOutputChannels()),
+                        MultiChannelSampleFifo<BlockType>::getBlockSizeFor(sampleRate, samplesPerBlock));
 
     // for fft test
     //osc.initialise([](float x) { return std::sin(x); });
@@ -125,10 +126,129 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     /*************************************************************************/
 }
 
+bool SimpleEQAudioProcessor::readEngineSettings()
+{
+    // the engine settings can't be automated, they take effect in prepareToPlay or through handleAsyncUpdate()
+    // (they're parameters so the host saves and restores them)
+    const auto newTopology = static_cast<FilterTopology>(juce::jlimit(0, (int)FilterTopology::StateVariable,
+                                                                      (int)apvts.getRawParameterValue("Filter Topology")->load()));
+    const auto newStages = juce::jlimit(0, 3, (int)apvts.getRawParameterValue("Oversampling")->load());
+    const auto newFilter = static_cast<OversamplingFilter>(juce::jlimit(0, (int)OversamplingFilter::EquirippleFIR,
+                                                                        (int)apvts.getRawParameterValue("Oversampling Filter")->load()));
+
+    const bool changed = newTopology != filterTopology
+                      || newStages != oversamplingStages
+                      || newFilter != oversamplingFilter;
+
+    filterTopology = newTopology;
+    oversamplingStages = newStages;
+    oversamplingFilter = newFilter;
+
+    return changed;
+}
+
+void SimpleEQAudioProcessor::prepareEngine(double sampleRate, int samplesPerBlock)
+{
+    // the host picks the precision before calling prepareToPlay
+    // only that pool is set up, the other one is emptied
+    if ( isUsingDoublePrecision() )
+    {
+        floatChains.chains.clear();
+        floatChains.oversampling.reset();
+        prepareChains<double>(sampleRate, samplesPerBlock);
+    }
+    else
+    {
+        doubleChains.chains.clear();
+        doubleChains.oversampling.reset();
+        prepareChains<float>(sampleRate, samplesPerBlock);
+    }
+}
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    triggerAsyncUpdate();
+
+    // on the message thread (the editor's combo box, a test) the switch happens right away
+    if ( juce::MessageManager::existsAndIsCurrentThread() )
+        handleUpdateNowIfNeeded();
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    // not prepared (yet): the next prepareToPlay reads the settings anyway
+    if ( preparedSampleRate <= 0.0 )
+        return;
+
+    // the wrappers only call processBlock under the callback lock and skip it while we're suspended,
+    // so nothing touches the chains while they're rebuilt
+    // prepareChains() reports the new latency, setLatencySamples() tells the host
+    suspendProcessing(true);
+
+    if ( readEngineSettings() )
+        prepareEngine(preparedSampleRate, preparedBlockSize);
+
+    suspendProcessing(false);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::prepareChains(double sampleRate, int samplesPerBlock)
+{
+    auto& pool = getChainPool<SampleType>();
+    const auto numChannels = juce::jmin(getTotalNumOutputChannels(), maxNumChannels);
+
+    // the oversampling stage (and all of its buffers) is only ever created here
+    pool.oversampling.reset();
+    oversamplingFactor = 1 << oversamplingStages;
+    oversamplingBlockSize = (size_t)juce::jmax(1, samplesPerBlock);
+
+    if ( oversamplingStages > 0 && numChannels > 0 )
+    {
+        using Oversampling = juce::dsp::Oversampling<SampleType>;
+        const auto filterType = oversamplingFilter == OversamplingFilter::EquirippleFIR
+                              ? Oversampling::filterHalfBandFIREquiripple
+                              : Oversampling::filterHalfBandPolyphaseIIR;
+
+        // integer latency, so what we report to the host is exact
+        pool.oversampling = std::make_unique<Oversampling>((size_t)numChannels, (size_t)oversamplingStages, filterType, true, true);
+        pool.oversampling->initProcessing((size_t)samplesPerBlock);
+    }
+
+    const auto latency = pool.oversampling != nullptr ? juce::roundToInt(pool.oversampling->getLatencyInSamples()) : 0;
+    setLatencySamples(latency);
+    tailLengthSeconds = latency / sampleRate;
+
+    filterSampleRate = sampleRate * oversamplingFactor;
+    const auto filterBlockSize = samplesPerBlock * oversamplingFactor;
+
+    // every channel gets a lane in one of the SIMD chains
+    // (one chain per SIMDChain::maxNumChannels channels)
+    const auto lanesPerChain = (int)SIMDChain<SampleType>::maxNumChannels;
+    const auto numChains = (numChannels + lanesPerChain - 1) / lanesPerChain;
+
+    pool.chains.resize((size_t)numChains);
+    for (int i = 0; i < numChains; ++i)
+    {
+        pool.chains[(size_t)i].prepare(juce::jmin(lanesPerChain, numChannels - i * lanesPerChain), filterBlockSize, filterTopology);
+    }
+
+    // Initial settings
+    // design synchronously here
+    // after that the designer thread takes over
+    // everything filter related runs at the oversampled rate
+    auto chainCoefficients = coefficientDesigner.prepare<SampleType>(filterSampleRate, filterTopology);
+    updateFilters(chainCoefficients);
+
+    pool.smoother.prepare(filterSampleRate, smoothingRampLengthSeconds);
+    pool.smoother.reset(chainCoefficients);
+}
+
 void SimpleEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    coefficientDesigner.release();
+    preparedSampleRate = 0.0;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -142,8 +262,14 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     // In this template code we only support mono or stereo.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    //if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+    // && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    //    return false;
+
+    // anything from mono up to maxNumChannels (7.1.4, 3rd order ambisonics, ...)
+    // every channel gets the same EQ
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -158,6 +284,19 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 #endif
 
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processBuffer(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processBuffer(buffer);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBuffer(juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -176,11 +315,36 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     
     // copy from prepareToPlay
     // set in process
+    // the design itself happens on the coefficient designer's thread
+    // here we only swap in a finished one (wait-free, no allocation)
 
-    updateFilters();
+    auto& pool = getChainPool<SampleType>();
+
+    updateFilters<SampleType>();
 
     // Block
-    juce::dsp::AudioBlock<float> block(buffer);
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+
+    if ( pool.oversampling != nullptr )
+    {
+        // only the channels the oversampler was set up for (the rest were cleared above)
+        auto channels = block.getSubsetChannelBlock(0, juce::jmin(block.getNumChannels(), (size_t)maxNumChannels));
+
+        // the oversampler's buffers were made for the prepared block size
+        // a bigger host block goes through in pieces of that
+        for (size_t start = 0; start < channels.getNumSamples(); start += oversamplingBlockSize)
+        {
+            auto chunk = channels.getSubBlock(start, juce::jmin(oversamplingBlockSize, channels.getNumSamples() - start));
+
+            auto oversampledBlock = pool.oversampling->processSamplesUp(chunk);
+            processSmoothed(oversampledBlock);
+            pool.oversampling->processSamplesDown(chunk);
+        }
+    }
+    else
+    {
+        processSmoothed(block);
+    }
 
     // for fft test
     //buffer.clear();
@@ -191,17 +355,10 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     //juce::dsp::ProcessContextReplacing<float> stereoContext(block);
     //osc.process(stereoContext);
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
-
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    if ( hasAnalyzerReaders() )
+        captureFifo.update(buffer);
+    else
+        captureFifo.skip(buffer.getNumSamples());
 
     /**************************************************************************/
     /*
@@ -220,6 +377,69 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     */
 }
 
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSmoothed(juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& pool = getChainPool<SampleType>();
+
+    // the stride is in host samples, so it's the same amount of time whatever the oversampling
+    const auto stride = (size_t)coefficientUpdateStride * (size_t)oversamplingFactor;
+    const auto numSamples = block.getNumSamples();
+    size_t start = 0;
+
+    // while a parameter ramp is running, process in sub-blocks of 'coefficientUpdateStride' samples
+    // and update the coefficients in between
+    while ( pool.smoother.isSmoothing() && start < numSamples )
+    {
+        auto length = juce::jmin(stride, numSamples - start);
+        updateSmoothedFilters<SampleType>((int)length);
+
+        auto subBlock = block.getSubBlock(start, length);
+        processChains(subBlock);
+
+        start += length;
+    }
+
+    // the rest of the block in one go
+    if ( start < numSamples )
+    {
+        auto subBlock = block.getSubBlock(start);
+        processChains(subBlock);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processChains(juce::dsp::AudioBlock<SampleType>& block)
+{
+    //auto leftBlock = block.getSingleChannelBlock(0);
+    //auto rightBlock = block.getSingleChannelBlock(1);
+    //juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
+    //juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    //leftChain.process(leftContext);
+    //rightChain.process(rightContext);
+
+    // all the channels, one SIMD chain (= up to SIMDChain::maxNumChannels channels) at a time
+    auto& chains = getChainPool<SampleType>().chains;
+    const auto lanesPerChain = SIMDChain<SampleType>::maxNumChannels;
+    const auto numChannels = block.getNumChannels();
+
+    for (size_t i = 0; i < chains.size() && i * lanesPerChain < numChannels; ++i)
+    {
+        auto channels = block.getSubsetChannelBlock(i * lanesPerChain,
+                                                    juce::jmin(lanesPerChain, numChannels - i * lanesPerChain));
+        chains[i].process(channels);
+    }
+}
+
+void SimpleEQAudioProcessor::setParameterSmoothing(double rampLengthSeconds, int stride)
+{
+    jassert(rampLengthSeconds >= 0.0);
+    jassert(stride > 0);
+
+    smoothingRampLengthSeconds = rampLengthSeconds;
+    coefficientUpdateStride = juce::jmax(1, stride);
+}
+
 //==============================================================================
 bool SimpleEQAudioProcessor::hasEditor() const
 {
@@ -259,7 +479,8 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     if ( tree.isValid() )
     {
         apvts.replaceState(tree);
-        updateFilters();
+        // don't touch the chains from here (this isn't the audio thread)
+        // the next processBlock sees the new parameter values and updates them
     }
     // we should be able to tweak the parameters and then it will be restored.
 }
@@ -299,98 +520,762 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename SampleType>
+BiquadCoefficients<SampleType> designPeakFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.peakFreq,
-                                                               chainSettings.peakQuality,
-                                                               juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    return juce::dsp::IIR::ArrayCoefficients<SampleType>::makePeakFilter(sampleRate,
+                                                                         chainSettings.peakFreq,
+                                                                         chainSettings.peakQuality,
+                                                                         juce::Decibels::decibelsToGain((SampleType)chainSettings.peakGainInDecibels));
 }
 
-// update the coefficients of Peak Filter
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+// the Q of each biquad in an even order Butterworth cascade
+// same formula FilterDesign::designIIR...HighOrderButterworthMethod uses
+static double getButterworthQuality(int stage, int order)
 {
-    //auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-    //                                                                            chainSettings.peakFreq,
-    //                                                                            chainSettings.peakQuality,
-    //                                                                            juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
-    // refactor : function makePeakFilter
+    return 1.0 / (2.0 * std::cos((2.0 * stage + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+}
 
-    //*leftChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    //*rightChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    // refactor : function updateCoefficients
+template<typename SampleType>
+CutCoefficients<SampleType> designLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    CutCoefficients<SampleType> cutCoefficients{};
+    const int order = 2 * (chainSettings.lowCutSlope + 1);
 
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    for (int stage = 0; stage < order / 2; ++stage)
+    {
+        cutCoefficients[stage] = juce::dsp::IIR::ArrayCoefficients<SampleType>::makeHighPass(sampleRate,
+                                                                                             chainSettings.lowCutFreq,
+                                                                                             static_cast<SampleType>(getButterworthQuality(stage, order)));
+    }
 
-    // set bypass state
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    return cutCoefficients;
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+template<typename SampleType>
+CutCoefficients<SampleType> designHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    CutCoefficients<SampleType> cutCoefficients{};
+    const int order = 2 * (chainSettings.highCutSlope + 1);
+
+    for (int stage = 0; stage < order / 2; ++stage)
+    {
+        cutCoefficients[stage] = juce::dsp::IIR::ArrayCoefficients<SampleType>::makeLowPass(sampleRate,
+                                                                                            chainSettings.highCutFreq,
+                                                                                            static_cast<SampleType>(getButterworthQuality(stage, order)));
+    }
+
+    return cutCoefficients;
 }
 
-void /*SimpleEQAudioProcessor::*/ updateCoefficients(Coefficients& old, const Coefficients& replacements)
+bool peakSettingsChanged(const ChainSettings& a, const ChainSettings& b)
 {
-    *old = *replacements;
+    return a.peakFreq != b.peakFreq
+        || a.peakGainInDecibels != b.peakGainInDecibels
+        || a.peakQuality != b.peakQuality
+        || a.peakBypassed != b.peakBypassed;
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+bool lowCutSettingsChanged(const ChainSettings& a, const ChainSettings& b)
 {
-    // LowCut
-    // juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(0, 0, 0); // (frequency, sampleRate, order)
-    //auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-    //                                                                                                      getSampleRate(),
-    //                                                                                                      2 * (chainSettings.lowCutSlope + 1));
-                                                                                                          // chainSettings.lowCutSlope: 0 1 2 3
-                                                                                                          // 0: 12 db/oct
-                                                                                                          // 1: 24 db/oct
-                                                                                                          // 2: 36 db/oct
-                                                                                                          // 3: 48 db/oct
-                                                                                                          // order: 2 4 6 8
-    
-    // refactor code 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    return a.lowCutFreq != b.lowCutFreq
+        || a.lowCutSlope != b.lowCutSlope
+        || a.lowCutBypassed != b.lowCutBypassed;
+}
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+bool highCutSettingsChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.highCutFreq != b.highCutFreq
+        || a.highCutSlope != b.highCutSlope
+        || a.highCutBypassed != b.highCutBypassed;
+}
 
-    // set bypass state
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+// Andrew Simper's TPT state variable filter
+// g = tan(pi * f / sampleRate), k = 1 / Q, output = m0 * input + m1 * bandpass + m2 * lowpass
+template<typename SampleType>
+static SVFCoefficients<SampleType> makeSVF(double g, double k, double m0, double m1, double m2)
+{
+    const auto a1 = 1.0 / (1.0 + g * (g + k));
+    const auto a2 = g * a1;
+    const auto a3 = g * a2;
 
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+    return { (SampleType)a1, (SampleType)a2, (SampleType)a3, (SampleType)m0, (SampleType)m1, (SampleType)m2 };
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+template<typename SampleType>
+SVFCoefficients<SampleType> designPeakSVF(const ChainSettings& chainSettings, double sampleRate)
 {
-    // HighCut
-    //auto highCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-    //                                                                                                      getSampleRate(),
-    //                                                                                                      2 * (chainSettings.highCutSlope + 1));
+    // the bell version has exactly the response of makePeakFilter
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain((double)chainSettings.peakGainInDecibels));
+    const auto g = std::tan(juce::MathConstants<double>::pi * chainSettings.peakFreq / sampleRate);
+    const auto k = 1.0 / (chainSettings.peakQuality * A);
 
-    // refactor code
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    return makeSVF<SampleType>(g, k, 1.0, k * (A * A - 1.0), 0.0);
+}
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+template<typename SampleType>
+CutSVFCoefficients<SampleType> designLowCutSVF(const ChainSettings& chainSettings, double sampleRate)
+{
+    CutSVFCoefficients<SampleType> cutCoefficients{};
+    const int order = 2 * (chainSettings.lowCutSlope + 1);
+    const auto g = std::tan(juce::MathConstants<double>::pi * chainSettings.lowCutFreq / sampleRate);
 
-    // set bypass state
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    for (int stage = 0; stage < order / 2; ++stage)
+    {
+        const auto k = 1.0 / getButterworthQuality(stage, order);
+        cutCoefficients[stage] = makeSVF<SampleType>(g, k, 1.0, -k, -1.0);     // highpass
+    }
+
+    return cutCoefficients;
+}
+
+template<typename SampleType>
+CutSVFCoefficients<SampleType> designHighCutSVF(const ChainSettings& chainSettings, double sampleRate)
+{
+    CutSVFCoefficients<SampleType> cutCoefficients{};
+    const int order = 2 * (chainSettings.highCutSlope + 1);
+    const auto g = std::tan(juce::MathConstants<double>::pi * chainSettings.highCutFreq / sampleRate);
+
+    for (int stage = 0; stage < order / 2; ++stage)
+    {
+        const auto k = 1.0 / getButterworthQuality(stage, order);
+        cutCoefficients[stage] = makeSVF<SampleType>(g, k, 0.0, 0.0, 1.0);     // lowpass
+    }
 
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    return cutCoefficients;
 }
 
+template<typename SampleType>
+ChainCoefficients<SampleType> designChainCoefficients(const ChainSettings& chainSettings, double sampleRate, FilterTopology topology)
+{
+    ChainCoefficients<SampleType> chainCoefficients;
+    chainCoefficients.settings = chainSettings;
+    chainCoefficients.topology = topology;
+
+    designBand(chainCoefficients, ChainPositions::Peak, sampleRate);
+    designBand(chainCoefficients, ChainPositions::LowCut, sampleRate);
+    designBand(chainCoefficients, ChainPositions::HighCut, sampleRate);
+
+    return chainCoefficients;
+}
+
+template<typename SampleType>
+void designBand(ChainCoefficients<SampleType>& chainCoefficients, ChainPositions band, double sampleRate)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+    const bool svf = chainCoefficients.topology == FilterTopology::StateVariable;
+
+    switch (band)
+    {
+    case Peak:
+        if ( svf ) chainCoefficients.peakSVF = designPeakSVF<SampleType>(chainSettings, sampleRate);
+        else chainCoefficients.peak = designPeakFilter<SampleType>(chainSettings, sampleRate);
+        break;
+    case LowCut:
+        if ( svf ) chainCoefficients.lowCutSVF = designLowCutSVF<SampleType>(chainSettings, sampleRate);
+        else chainCoefficients.lowCut = designLowCutFilter<SampleType>(chainSettings, sampleRate);
+        break;
+    case HighCut:
+        if ( svf ) chainCoefficients.highCutSVF = designHighCutSVF<SampleType>(chainSettings, sampleRate);
+        else chainCoefficients.highCut = designHighCutFilter<SampleType>(chainSettings, sampleRate);
+        break;
+    default:
+        break;
+    }
+}
+
+template<typename SampleType>
+void applyChainCoefficients(MonoChain<SampleType>& chain, const ChainCoefficients<SampleType>& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    chain.template setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    chain.template setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    chain.template setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+
+    updateCoefficients(chain.template get<ChainPositions::Peak>().coefficients, chainCoefficients.peak);
+    updateCutFilter(chain.template get<ChainPositions::LowCut>(), chainCoefficients.lowCut, chainSettings.lowCutSlope);
+    updateCutFilter(chain.template get<ChainPositions::HighCut>(), chainCoefficients.highCut, chainSettings.highCutSlope);
+}
+
+// the design functions are used with both precisions
+#define SIMPLEEQ_INSTANTIATE_DESIGN(SampleType) \
+    template BiquadCoefficients<SampleType> designPeakFilter<SampleType>(const ChainSettings&, double); \
+    template CutCoefficients<SampleType> designLowCutFilter<SampleType>(const ChainSettings&, double); \
+    template CutCoefficients<SampleType> designHighCutFilter<SampleType>(const ChainSettings&, double); \
+    template SVFCoefficients<SampleType> designPeakSVF<SampleType>(const ChainSettings&, double); \
+    template CutSVFCoefficients<SampleType> designLowCutSVF<SampleType>(const ChainSettings&, double); \
+    template CutSVFCoefficients<SampleType> designHighCutSVF<SampleType>(const ChainSettings&, double); \
+    template ChainCoefficients<SampleType> designChainCoefficients<SampleType>(const ChainSettings&, double, FilterTopology); \
+    template void designBand<SampleType>(ChainCoefficients<SampleType>&, ChainPositions, double); \
+    template void applyChainCoefficients<SampleType>(MonoChain<SampleType>&, const ChainCoefficients<SampleType>&);
+
+SIMPLEEQ_INSTANTIATE_DESIGN(float)
+SIMPLEEQ_INSTANTIATE_DESIGN(double)
+
+#undef SIMPLEEQ_INSTANTIATE_DESIGN
+
+//==============================================================================
+template<typename SampleType>
+void SIMDChain<SampleType>::prepare(int numChannels, int maximumBlockSize, FilterTopology newTopology)
+{
+    jassert(numChannels <= (int)maxNumChannels);
+    numChannelsToProcess = (size_t)juce::jlimit(0, (int)maxNumChannels, numChannels);
+    topology = newTopology;
+
+    // one channel of SIMDType, 'maximumBlockSize' samples, properly aligned
+    interleaved = juce::dsp::AudioBlock<SIMDType>(interleavedData, 1, (size_t)maximumBlockSize);
+
+    // lanes without a channel only ever see zeros
+    interleaved.clear();
+
+    reset();
+}
+
+template<typename SampleType>
+void SIMDChain<SampleType>::reset()
+{
+    for (int i = 0; i < numSections; ++i)
+    {
+        state1[i] = SIMDType::expand(SampleType(0));
+        state2[i] = SIMDType::expand(SampleType(0));
+    }
+}
+
+template<typename SampleType>
+void SIMDChain<SampleType>::setCoefficients(const ChainCoefficients<SampleType>& chainCoefficients)
+{
+    // the designer has to design for the topology we were prepared with
+    jassert(chainCoefficients.topology == topology);
+
+    const auto& chainSettings = chainCoefficients.settings;
+    const bool svf = topology == FilterTopology::StateVariable;
+    numActiveSections = 0;
+
+    auto addSection = [this, svf](int index, const std::array<SampleType, 6>& c)
+    {
+        auto& section = sections[index];
+
+        if ( svf )
+        {
+            for (size_t i = 0; i < c.size(); ++i)
+                section.c[i] = SIMDType::expand(c[i]);
+        }
+        else
+        {
+            // normalised exactly like juce::dsp::IIR::Coefficients does it
+            const auto a0inv = SampleType(1) / c[3];
+
+            section.c[0] = SIMDType::expand(c[0] * a0inv);
+            section.c[1] = SIMDType::expand(c[1] * a0inv);
+            section.c[2] = SIMDType::expand(c[2] * a0inv);
+            section.c[3] = SIMDType::expand(c[4] * a0inv);
+            section.c[4] = SIMDType::expand(c[5] * a0inv);
+            section.c[5] = SIMDType::expand(SampleType(0));
+        }
+
+        activeSections[numActiveSections++] = index;
+    };
+
+    // same order as the MonoChain: LowCut -> Peak -> HighCut
+    // only the stages the slope needs, so the inner loop never has to check anything
+    if ( ! chainSettings.lowCutBypassed )
+    {
+        for (int stage = 0; stage <= chainSettings.lowCutSlope; ++stage)
+            addSection(stage, svf ? chainCoefficients.lowCutSVF[stage] : chainCoefficients.lowCut[stage]);
+    }
+
+    if ( ! chainSettings.peakBypassed )
+        addSection(4, svf ? chainCoefficients.peakSVF : chainCoefficients.peak);
+
+    if ( ! chainSettings.highCutBypassed )
+    {
+        for (int stage = 0; stage <= chainSettings.highCutSlope; ++stage)
+            addSection(5 + stage, svf ? chainCoefficients.highCutSVF[stage] : chainCoefficients.highCut[stage]);
+    }
+}
+
+template<typename SampleType>
+template<FilterTopology Topology>
+void SIMDChain<SampleType>::processSections(SIMDType* samples, size_t numSamples)
+{
+    // gather the active sections so the inner loop doesn't jump around
+    std::array<Section, numSections> sec;
+    std::array<SIMDType, numSections> s1, s2;
+    const int numActive = numActiveSections;
+
+    for (int k = 0; k < numActive; ++k)
+    {
+        sec[k] = sections[activeSections[k]];
+        s1[k] = state1[activeSections[k]];
+        s2[k] = state2[activeSections[k]];
+    }
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i];
+
+        for (int k = 0; k < numActive; ++k)
+        {
+            const auto& c = sec[k].c;
+
+            if constexpr ( Topology == FilterTopology::TransposedDirectForm2 )
+            {
+                // juce::dsp::IIR::Filter::processSamples, 2nd order case
+                auto y = (x * c[0]) + s1[k];
+                s1[k] = (x * c[1]) - (y * c[3]) + s2[k];
+                s2[k] = (x * c[2]) - (y * c[4]);
+                x = y;
+            }
+            else
+            {
+                // TPT state variable filter, s1/s2 are the two integrator states
+                auto v3 = x - s2[k];
+                auto v1 = (c[0] * s1[k]) + (c[1] * v3);
+                auto v2 = s2[k] + (c[1] * s1[k]) + (c[2] * v3);
+                s1[k] = v1 + v1 - s1[k];
+                s2[k] = v2 + v2 - s2[k];
+                x = (c[3] * x) + (c[4] * v1) + (c[5] * v2);
+            }
+        }
+
+        samples[i] = x;
+    }
+
+    // put the state back, flushing tiny values to zero like the IIR filter does at the end of a block
+    auto snapToZero = [](SIMDType& v)
+    {
+        for (size_t lane = 0; lane < SIMDType::size(); ++lane)
+        {
+            auto value = v.get(lane);
+            juce::dsp::util::snapToZero(value);
+            v.set(lane, value);
+        }
+    };
+
+    for (int k = 0; k < numActive; ++k)
+    {
+        snapToZero(s1[k]);
+        snapToZero(s2[k]);
+        state1[activeSections[k]] = s1[k];
+        state2[activeSections[k]] = s2[k];
+    }
+}
+
+template<typename SampleType>
+void SIMDChain<SampleType>::process(juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = juce::jmin(block.getNumChannels(), numChannelsToProcess);
+    const auto chunkSize = interleaved.getNumSamples();
+
+    if ( numActiveSections == 0 || numChannels == 0 || chunkSize == 0 )
+        return;
+
+    constexpr auto numLanes = SIMDType::size();
+    auto* samples = interleaved.getChannelPointer(0);
+    auto* lanes = reinterpret_cast<SampleType*>(samples);
+
+    // the scratch block holds the prepared block size
+    // a bigger host block goes through in chunks of that (the filter state carries over)
+    for (size_t start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto numToProcess = juce::jmin(chunkSize, numSamples - start);
+
+        // interleave
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            auto* src = block.getChannelPointer(ch) + start;
+            for (size_t i = 0; i < numToProcess; ++i)
+                lanes[i * numLanes + ch] = src[i];
+        }
+
+        // the topology is fixed at prepare time, one branch per chunk
+        if ( topology == FilterTopology::StateVariable )
+            processSections<FilterTopology::StateVariable>(samples, numToProcess);
+        else
+            processSections<FilterTopology::TransposedDirectForm2>(samples, numToProcess);
+
+        // deinterleave
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            auto* dst = block.getChannelPointer(ch) + start;
+            for (size_t i = 0; i < numToProcess; ++i)
+                dst[i] = lanes[i * numLanes + ch];
+        }
+    }
+}
+
+//==============================================================================
+template<typename SampleType>
+void ChainSmoother<SampleType>::prepare(double newSampleRate, double rampLengthSeconds)
+{
+    sampleRate = newSampleRate;
+
+    peakFreq.reset(sampleRate, rampLengthSeconds);
+    peakGain.reset(sampleRate, rampLengthSeconds);
+    peakQuality.reset(sampleRate, rampLengthSeconds);
+    lowCutFreq.reset(sampleRate, rampLengthSeconds);
+    highCutFreq.reset(sampleRate, rampLengthSeconds);
+}
+
+template<typename SampleType>
+void ChainSmoother<SampleType>::reset(const ChainCoefficients<SampleType>& chainCoefficients)
+{
+    target = chainCoefficients;
+    pendingBands = 0;
+
+    const auto& chainSettings = target.settings;
+    peakFreq.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakGain.setCurrentAndTargetValue(chainSettings.peakGainInDecibels);
+    peakQuality.setCurrentAndTargetValue(chainSettings.peakQuality);
+    lowCutFreq.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(chainSettings.highCutFreq);
+}
+
+template<typename SampleType>
+void ChainSmoother<SampleType>::setTarget(const ChainCoefficients<SampleType>& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    if ( peakSettingsChanged(chainSettings, target.settings) )
+        pendingBands |= 1 << ChainPositions::Peak;
+    if ( lowCutSettingsChanged(chainSettings, target.settings) )
+        pendingBands |= 1 << ChainPositions::LowCut;
+    if ( highCutSettingsChanged(chainSettings, target.settings) )
+        pendingBands |= 1 << ChainPositions::HighCut;
+
+    target = chainCoefficients;
+
+    peakFreq.setTargetValue(chainSettings.peakFreq);
+    peakGain.setTargetValue(chainSettings.peakGainInDecibels);
+    peakQuality.setTargetValue(chainSettings.peakQuality);
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+}
+
+template<typename SampleType>
+int ChainSmoother<SampleType>::process(int numSamples, ChainCoefficients<SampleType>& result)
+{
+    // slopes and bypass states come straight from the target
+    result = target;
+    auto& chainSettings = result.settings;
+    const int bands = pendingBands;
+
+    // a band that is still ramping gets redesigned from the current (smoothed) values
+    // a band whose ramp has finished gets the designer's coefficients and stops being pending
+    if ( bands & (1 << ChainPositions::Peak) )
+    {
+        if ( peakFreq.isSmoothing() || peakGain.isSmoothing() || peakQuality.isSmoothing() )
+        {
+            chainSettings.peakFreq = peakFreq.getCurrentValue();
+            chainSettings.peakGainInDecibels = peakGain.getCurrentValue();
+            chainSettings.peakQuality = peakQuality.getCurrentValue();
+            designBand(result, ChainPositions::Peak, sampleRate);
+
+            peakFreq.skip(numSamples);
+            peakGain.skip(numSamples);
+            peakQuality.skip(numSamples);
+        }
+        else
+        {
+            pendingBands &= ~(1 << ChainPositions::Peak);
+        }
+    }
+
+    if ( bands & (1 << ChainPositions::LowCut) )
+    {
+        if ( lowCutFreq.isSmoothing() )
+        {
+            chainSettings.lowCutFreq = lowCutFreq.getCurrentValue();
+            designBand(result, ChainPositions::LowCut, sampleRate);
+            lowCutFreq.skip(numSamples);
+        }
+        else
+        {
+            pendingBands &= ~(1 << ChainPositions::LowCut);
+        }
+    }
+
+    if ( bands & (1 << ChainPositions::HighCut) )
+    {
+        if ( highCutFreq.isSmoothing() )
+        {
+            chainSettings.highCutFreq = highCutFreq.getCurrentValue();
+            designBand(result, ChainPositions::HighCut, sampleRate);
+            highCutFreq.skip(numSamples);
+        }
+        else
+        {
+            pendingBands &= ~(1 << ChainPositions::HighCut);
+        }
+    }
+
+    return bands;
+}
+
+//==============================================================================
+void FrequencyResponseEvaluator::prepare(const double* frequencies, int newNumFrequencies, double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    numFrequencies = juce::jmax(0, newNumFrequencies);
+
+    constexpr auto numLanes = SIMDType::size();
+    const auto numRegisters = ((size_t)numFrequencies + numLanes - 1) / numLanes;
+
+    for (auto* table : { &cosW, &sinW, &cos2W, &sin2W, &numeratorPower, &denominatorPower })
+        table->resize(numRegisters);
+
+    // std::vector<SIMDType> is aligned for SIMDType, so the lanes can be written as plain doubles
+    auto* c1 = reinterpret_cast<double*>(cosW.data());
+    auto* s1 = reinterpret_cast<double*>(sinW.data());
+    auto* c2 = reinterpret_cast<double*>(cos2W.data());
+    auto* s2 = reinterpret_cast<double*>(sin2W.data());
+
+    for (size_t i = 0; i < numRegisters * numLanes; ++i)
+    {
+        const auto w = i < (size_t)numFrequencies ? juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate : 0.0;
+        c1[i] = std::cos(w);
+        s1[i] = std::sin(w);
+        c2[i] = std::cos(2.0 * w);
+        s2[i] = std::sin(2.0 * w);
+    }
+}
+
+void FrequencyResponseEvaluator::prepareLogGrid(int numPoints, double newSampleRate, double minFreq, double maxFreq)
+{
+    std::vector<double> frequencies((size_t)juce::jmax(0, numPoints));
+    for (int i = 0; i < numPoints; ++i)
+        frequencies[(size_t)i] = juce::mapToLog10(double(i) / double(numPoints), minFreq, maxFreq);
+
+    prepare(frequencies.data(), numPoints, newSampleRate);
+}
+
+template<typename SampleType>
+void FrequencyResponseEvaluator::multiplyPower(const BiquadCoefficients<SampleType>& biquad)
+{
+    // b0 b1 b2 a0 a1 a2, a0 isn't necessarily 1 (it cancels out)
+    const auto b0 = SIMDType::expand((double)biquad[0]);
+    const auto b1 = SIMDType::expand((double)biquad[1]);
+    const auto b2 = SIMDType::expand((double)biquad[2]);
+    const auto a0 = SIMDType::expand((double)biquad[3]);
+    const auto a1 = SIMDType::expand((double)biquad[4]);
+    const auto a2 = SIMDType::expand((double)biquad[5]);
+
+    // |b0 + b1 e^-jw + b2 e^-2jw|^2 and |a0 + a1 e^-jw + a2 e^-2jw|^2
+    for (size_t i = 0; i < cosW.size(); ++i)
+    {
+        const auto reN = b0 + b1 * cosW[i] + b2 * cos2W[i];
+        const auto imN = b1 * sinW[i] + b2 * sin2W[i];
+        const auto reD = a0 + a1 * cosW[i] + a2 * cos2W[i];
+        const auto imD = a1 * sinW[i] + a2 * sin2W[i];
+
+        numeratorPower[i] *= reN * reN + imN * imN;
+        denominatorPower[i] *= reD * reD + imD * imD;
+    }
+}
+
+template<typename SampleType>
+void FrequencyResponseEvaluator::multiplyBandPower(const ChainCoefficients<SampleType>& chainCoefficients, ChainPositions band)
+{
+    // only the biquad design is evaluated (the SVF topology realises the same responses)
+    jassert(chainCoefficients.topology == FilterTopology::TransposedDirectForm2);
+    const auto& settings = chainCoefficients.settings;
+
+    switch ( band )
+    {
+        case ChainPositions::Peak:
+            if ( ! settings.peakBypassed )
+                multiplyPower(chainCoefficients.peak);
+            break;
+        case ChainPositions::LowCut:
+            // Slope_12 -> 1 stage ... Slope_48 -> 4 stages, like updateCutFilter()
+            if ( ! settings.lowCutBypassed )
+                for (int stage = 0; stage <= (int)settings.lowCutSlope; ++stage)
+                    multiplyPower(chainCoefficients.lowCut[(size_t)stage]);
+            break;
+        case ChainPositions::HighCut:
+            if ( ! settings.highCutBypassed )
+                for (int stage = 0; stage <= (int)settings.highCutSlope; ++stage)
+                    multiplyPower(chainCoefficients.highCut[(size_t)stage]);
+            break;
+    }
+}
+
+void FrequencyResponseEvaluator::resetPower()
+{
+    std::fill(numeratorPower.begin(), numeratorPower.end(), SIMDType::expand(1.0));
+    std::fill(denominatorPower.begin(), denominatorPower.end(), SIMDType::expand(1.0));
+}
+
+void FrequencyResponseEvaluator::powerToDecibels(double* decibels) const
+{
+    const auto* numerator = reinterpret_cast<const double*>(numeratorPower.data());
+    const auto* denominator = reinterpret_cast<const double*>(denominatorPower.data());
+
+    // 10 * log10 of the power == 20 * log10 of the magnitude
+    for (int i = 0; i < numFrequencies; ++i)
+    {
+        const auto power = numerator[i] / denominator[i];
+        decibels[i] = power > 0.0 ? juce::jmax(-100.0, 10.0 * std::log10(power)) : -100.0;
+    }
+}
+
+template<typename SampleType>
+void FrequencyResponseEvaluator::getBandDecibels(const ChainCoefficients<SampleType>& chainCoefficients, ChainPositions band, double* decibels)
+{
+    resetPower();
+    multiplyBandPower(chainCoefficients, band);
+    powerToDecibels(decibels);
+}
+
+template<typename SampleType>
+void FrequencyResponseEvaluator::getChainDecibels(const ChainCoefficients<SampleType>& chainCoefficients, double* decibels)
+{
+    resetPower();
+    multiplyBandPower(chainCoefficients, ChainPositions::LowCut);
+    multiplyBandPower(chainCoefficients, ChainPositions::Peak);
+    multiplyBandPower(chainCoefficients, ChainPositions::HighCut);
+    powerToDecibels(decibels);
+}
+
+template void FrequencyResponseEvaluator::getBandDecibels<float>(const ChainCoefficients<float>&, ChainPositions, double*);
+template void FrequencyResponseEvaluator::getBandDecibels<double>(const ChainCoefficients<double>&, ChainPositions, double*);
+template void FrequencyResponseEvaluator::getChainDecibels<float>(const ChainCoefficients<float>&, double*);
+template void FrequencyResponseEvaluator::getChainDecibels<double>(const ChainCoefficients<double>&, double*);
+
+//==============================================================================
+template struct SIMDChain<float>;
+template struct SIMDChain<double>;
+template struct ChainSmoother<float>;
+template struct ChainSmoother<double>;
+
+//==============================================================================
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& vts) :
+juce::Thread("SimpleEQ coefficient designer"),
+apvts(vts)
+{
+    for (auto* param : apvts.processor.getParameters())
+    {
+        param->addListener(this);
+    }
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    for (auto* param : apvts.processor.getParameters())
+    {
+        param->removeListener(this);
+    }
+
+    stopThread(1000);
+}
+
+template<typename SampleType>
+ChainCoefficients<SampleType> CoefficientDesigner::prepare(double newSampleRate, FilterTopology newTopology)
+{
+    stopThread(1000);
+
+    // throw away anything designed for the old sample rate / precision
+    ChainCoefficients<float> staleFloat;
+    floatSlot.pull(staleFloat);
+    ChainCoefficients<double> staleDouble;
+    doubleSlot.pull(staleDouble);
+
+    sampleRate.store(newSampleRate);
+    topology = newTopology;
+    doublePrecision = std::is_same_v<SampleType, double>;
+    lastSampleRate = newSampleRate;
+
+    // clear the flag before reading: a change that lands while we read is picked up by the thread
+    parametersChanged.store(false);
+    lastChainSettings = getChainSettings(apvts);
+
+    auto chainCoefficients = designChainCoefficients<SampleType>(lastChainSettings, lastSampleRate, topology);
+
+    lastChangeMs = juce::Time::getMillisecondCounter();
+    startThread();
+
+    return chainCoefficients;
+}
+
+template ChainCoefficients<float> CoefficientDesigner::prepare<float>(double, FilterTopology);
+template ChainCoefficients<double> CoefficientDesigner::prepare<double>(double, FilterTopology);
+
+void CoefficientDesigner::release()
+{
+    stopThread(1000);
+}
+
+void CoefficientDesigner::parameterValueChanged(int parameterIndex, float newValue)
+{
+    parametersChanged.store(true);
+
+    // notify() takes a lock, so only wake the thread up straight away from the message thread
+    // everyone else (i.e. the audio thread during automation) waits for the next poll
+    if ( juce::MessageManager::existsAndIsCurrentThread() )
+        notify();
+}
+
+void CoefficientDesigner::run()
+{
+    while ( ! threadShouldExit() )
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+
+        if ( parametersChanged.exchange(false) )
+        {
+            lastChangeMs = now;
+
+            auto chainSettings = getChainSettings(apvts);
+            auto currentSampleRate = sampleRate.load();
+
+            // only publish when something that matters actually moved
+            if ( currentSampleRate != lastSampleRate
+                || peakSettingsChanged(chainSettings, lastChainSettings)
+                || lowCutSettingsChanged(chainSettings, lastChainSettings)
+                || highCutSettingsChanged(chainSettings, lastChainSettings) )
+            {
+                if ( doublePrecision )
+                    doubleSlot.push(designChainCoefficients<double>(chainSettings, currentSampleRate, topology));
+                else
+                    floatSlot.push(designChainCoefficients<float>(chainSettings, currentSampleRate, topology));
+
+                lastChainSettings = chainSettings;
+                lastSampleRate = currentSampleRate;
+            }
+        }
+
+        // automation keeps coming in steps: poll quickly while it lasts, sleep once it's over
+        const auto isActive = now - lastChangeMs < (juce::uint32)activePollTimeMs;
+        wait(isActive ? pollIntervalMs : idleWaitMs);
+    }
+}
+
+template<typename SampleType>
 void SimpleEQAudioProcessor::updateFilters()
 {
-    auto chainSettings = getChainSettings(apvts);
+    // nothing moved -> the designer published nothing -> nothing to do
+    // otherwise ramp towards the new design (see updateSmoothedFilters)
+    ChainCoefficients<SampleType> chainCoefficients;
+    if ( coefficientDesigner.getNewCoefficients(chainCoefficients) )
+        getChainPool<SampleType>().smoother.setTarget(chainCoefficients);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSmoothedFilters(int numSamples)
+{
+    // the smoother always hands back a complete set (ramping bands + everything else from the target)
+    ChainCoefficients<SampleType> chainCoefficients;
+    if ( getChainPool<SampleType>().smoother.process(numSamples, chainCoefficients) != 0 )
+        updateFilters(chainCoefficients);
+}
 
-    updatePeakFilter(chainSettings);
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateFilters(const ChainCoefficients<SampleType>& chainCoefficients)
+{
+    for (auto& chain : getChainPool<SampleType>().chains)
+        chain.setCoefficients(chainCoefficients);
 }
 
 // where the parameters are created
@@ -444,6 +1329,52 @@ SimpleEQAudioProcessor::createParameterLayout()
     layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
 
+    // the analyzer FFT size: 2048 (~23Hz bins at 48kHz), 4096, 8192 (~5.9Hz bins)
+    // or multi-resolution: the same number of bins in every octave
+    // it only affects the display, so the host can't automate it
+    layout.add(std::make_unique<NonAutomatableChoice>("Analyzer FFT Order",
+                                                      "Analyzer FFT Order",
+                                                      juce::StringArray{ "2048", "4096", "8192", "Multi-Res" },
+                                                      0));
+
+    // what the analyzer shows: latest frame, average, peak hold or max hold (see AnalyzerMode)
+    layout.add(std::make_unique<NonAutomatableChoice>("Analyzer Mode",
+                                                      "Analyzer Mode",
+                                                      juce::StringArray{ "Latest", "Average", "Peak Hold", "Max Hold" },
+                                                      0));
+
+    // the analyzer traces: left & right, or mid (L+R) & side (L-R)
+    layout.add(std::make_unique<NonAutomatableChoice>("Analyzer Channels",
+                                                      "Analyzer Channels",
+                                                      juce::StringArray{ "Left / Right", "Mid / Side" },
+                                                      0));
+
+    // how the analyzer traces are drawn: juce::Path (software) or OpenGL vertex buffers
+    // (OpenGL falls back to software when there's no GL)
+    layout.add(std::make_unique<NonAutomatableChoice>("Analyzer Renderer",
+                                                      "Analyzer Renderer",
+                                                      juce::StringArray{ "Software", "OpenGL" },
+                                                      0));
+
+    // the processing engine's sections: TDF-II biquads or state variable filters (see FilterTopology)
+    // switching it rebuilds the chains (see handleAsyncUpdate()), so the host can't automate it
+    layout.add(std::make_unique<NonAutomatableChoice>("Filter Topology",
+                                                      "Filter Topology",
+                                                      juce::StringArray{ "Biquad", "State Variable" },
+                                                      0));
+
+    // runs the chains at 2x / 4x / 8x the host rate, keeps the peak / high cut bands from cramping near Nyquist
+    // with the half-band filters to use: polyphase IIR (cheap, small latency) or equiripple FIR (linear phase)
+    // the latency changes with them, so switching them rebuilds the chains (see handleAsyncUpdate()) and the host can't automate them
+    layout.add(std::make_unique<NonAutomatableChoice>("Oversampling",
+                                                      "Oversampling",
+                                                      juce::StringArray{ "Off", "2x", "4x", "8x" },
+                                                      0));
+    layout.add(std::make_unique<NonAutomatableChoice>("Oversampling Filter",
+                                                      "Oversampling Filter",
+                                                      juce::StringArray{ "Polyphase IIR", "Linear Phase FIR" },
+                                                      0));
+
     return layout;
 }
 
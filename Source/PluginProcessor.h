@@ -19,12 +19,17 @@
 
 
 #include <array>
+#include <atomic>
 // while our single sample fifo is collecting individual samples
 // from the buffers into blocks
 // we need a fifo that the gui thread can use to retrieve these blocks
 // that this single channel sample fifo has produced
+// push/pull copy the whole object (for an AudioBuffer or a vector that's a deep copy,
+// and an allocation if the destination wasn't sized yet)
+// the BySwapping / InPlace versions don't copy anything
+// Capacity = how many items it can hold (juce::AbstractFifo keeps one slot free, so there's one more slot than that)
 /**************************************************************************/
-template<typename T>
+template<typename T, int Capacity = 30>
 struct Fifo
 {
     void prepare(int numChannels, int numSamples)
@@ -77,14 +82,140 @@ struct Fifo
         return false;
     }
 
+    // zero-copy: swaps the object with the slot
+    // the caller gets the slot's previous object back, so every object that goes
+    // through the fifo this way should have the same size (e.g. all prepared by prepare())
+    bool pushBySwapping(T& t)
+    {
+        auto write = fifo.write(1);
+        if (write.blockSize1 > 0)
+        {
+            std::swap(buffers[write.startIndex1], t);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool pullBySwapping(T& t)
+    {
+        auto read = fifo.read(1);
+        if (read.blockSize1 > 0)
+        {
+            std::swap(t, buffers[read.startIndex1]);
+            return true;
+        }
+
+        return false;
+    }
+
+    // zero-copy: hands out a reference to the slot itself
+    // 'fill' writes the next free slot, 'use' reads the oldest one
+    // the slot is only published / released once the callback has returned
+    template<typename Callback>
+    bool pushInPlace(Callback&& fill)
+    {
+        auto write = fifo.write(1);
+        if (write.blockSize1 > 0)
+        {
+            fill(buffers[write.startIndex1]);
+            return true;
+        }
+
+        return false;
+    }
+
+    template<typename Callback>
+    bool pullInPlace(Callback&& use)
+    {
+        auto read = fifo.read(1);
+        if (read.blockSize1 > 0)
+        {
+            use(buffers[read.startIndex1]);
+            return true;
+        }
+
+        return false;
+    }
+
+    // any other T: sets every slot up with a callback
+    template<typename Callback>
+    void prepareSlots(Callback&& prepareSlot)
+    {
+        for (auto& buffer : buffers)
+            prepareSlot(buffer);
+    }
+
     int getNumAvailableForReading() const
     {
         return fifo.getNumReady();
     }
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo{ Capacity };
+    static_assert(Capacity > 0, "a Fifo needs at least one slot");
+    static constexpr int numSlots = Capacity + 1;
+    std::array<T, numSlots> buffers;
+    juce::AbstractFifo fifo{ numSlots };
+};
+
+/**************************************************************************/
+// a single "latest value" slot between exactly one producer thread and one consumer thread
+// (a triple buffer)
+// push() and pull() are both wait-free: they never lock and never allocate
+// the consumer always gets the most recent value, older ones are simply overwritten
+template<typename T>
+struct LatestValueSlot
+{
+    // producer side
+    void push(const T& t)
+    {
+        buffers[back] = t;
+        // publish the back buffer and take back whatever buffer was in the middle
+        auto previous = middle.exchange(back | newDataFlag, std::memory_order_acq_rel);
+        back = previous & indexMask;
+    }
+
+    // producer side, zero-copy: 'fill' writes the back buffer itself
+    // it holds some older value, so 'fill' has to set everything
+    template<typename Callback>
+    void pushInPlace(Callback&& fill)
+    {
+        fill(buffers[back]);
+        auto previous = middle.exchange(back | newDataFlag, std::memory_order_acq_rel);
+        back = previous & indexMask;
+    }
+
+    // consumer side
+    // returns false if nothing new was pushed since the last pull
+    bool pull(T& t)
+    {
+        if ( (middle.load(std::memory_order_acquire) & newDataFlag) == 0 )
+            return false;
+
+        auto previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & indexMask;
+        t = buffers[front];
+        return true;
+    }
+
+    // consumer side, zero-copy: 't' and the newest value swap places
+    bool pullBySwapping(T& t)
+    {
+        if ( (middle.load(std::memory_order_acquire) & newDataFlag) == 0 )
+            return false;
+
+        auto previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & indexMask;
+        std::swap(t, buffers[front]);
+        return true;
+    }
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    std::array<T, 3> buffers;
+    std::atomic<int> middle{ 1 };
+    int back = 0;   // only touched by the producer
+    int front = 2;  // only touched by the consumer
 };
 
 /**************************************************************************/
@@ -101,67 +232,160 @@ enum Channel
 // so we need a way to collect them into blocks of fixed sizes 
 // that's what this class does
 // the hard part
+// (replaces one SingleChannelSampleFifo per channel: all the captured channels share one ring,
+// written once per host block, and every block carries its position so readers can spot gaps)
 template<typename BlockType>
-struct SingleChannelSampleFifo
+struct MultiChannelSampleFifo
 {
-    SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
+    // one slot of the ring
+    struct CapturedBlock
+    {
+        BlockType buffer;
+        juce::int64 position = 0;   // index of the first sample in 'buffer', counted since prepare()
+    };
+
+    MultiChannelSampleFifo()
     {
         prepared.set(false);
     }
 
-    void update(const BlockType& buffer)
+    // the ring holds numSlots blocks, the block size decides how much time that is
+    static constexpr int numSlots = 30;
+    // the reader only comes by every frame (16ms + the FFTs and paths), so the ring has to cover
+    // at least minRingSeconds, and minHostBlocks host blocks (update() publishes a whole host block at once)
+    static constexpr double minRingSeconds = 0.15;
+    static constexpr int minHostBlocks = 3;
+
+    // the block size to prepare() with: ~5ms blocks, bigger for big host blocks
+    // (host sized blocks were ~20ms of ring at 32 samples / 48kHz, the reader couldn't keep up)
+    static int getBlockSizeFor(double sampleRate, int hostBlockSize)
+    {
+        const auto forTime = (int)std::ceil(sampleRate * minRingSeconds / numSlots);
+        const auto forHostBlocks = (minHostBlocks * juce::jmax(1, hostBlockSize) + numSlots - 1) / numSlots;
+        return juce::jmax(1, forTime, forHostBlocks);
+    }
+
+    // copies the host buffer in spans: as much as fits into the block being filled,
+    // publish it when it's full, carry on with the rest
+    // any host block size works (smaller, larger, or not a divisor of the fifo block size)
+    // the analyzer always works in float, double buffers are converted on the way
+    template<typename SampleType>
+    void update(const juce::AudioBuffer<SampleType>& buffer)
     {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        auto& blockToFill = bufferToFill.buffer;
+        const auto blockSize = blockToFill.getNumSamples();
+        const auto numChannels = blockToFill.getNumChannels();
+        if ( buffer.getNumChannels() == 0 || blockSize == 0 || numChannels == 0 )
+            return;
 
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        const auto numSamples = buffer.getNumSamples();
+
+        for (int index = 0; index < numSamples; )
         {
-            pushNextSampleIntoFifo(channelPtr[i]);
+            const auto numToCopy = juce::jmin(numSamples - index, blockSize - fifoIndex);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                // fewer channels than we capture: repeat the last one
+                auto* src = buffer.getReadPointer(juce::jmin(ch, buffer.getNumChannels() - 1), index);
+                auto* dest = blockToFill.getWritePointer(ch, fifoIndex);
+
+                if constexpr ( std::is_same_v<SampleType, float> )
+                {
+                    juce::FloatVectorOperations::copy(dest, src, numToCopy);
+                }
+                else
+                {
+                    for (int i = 0; i < numToCopy; ++i)
+                        dest[i] = static_cast<float>(src[i]);
+                }
+            }
+
+            fifoIndex += numToCopy;
+            index += numToCopy;
+
+            if ( fifoIndex == blockSize )
+                publishBlock(samplesWritten + index);
         }
+
+        samplesWritten += numSamples;
+        writePosition.store(samplesWritten);
     }
 
-    void prepare(int bufferSize)
+    // nobody is reading: let the time pass without copying anything
+    // the half filled block is thrown away, so the next block starts after the gap
+    // (and a reader that comes back sees the jump in the positions)
+    void skip(int numSamples)
+    {
+        samplesWritten += numSamples;
+        fifoIndex = 0;
+        bufferToFill.position = samplesWritten;
+        writePosition.store(samplesWritten);
+    }
+
+    void prepare(int numChannels, int bufferSize)
     {
         prepared.set(false);
         size.set(bufferSize);
+        channels.set(numChannels);
 
-        bufferToFill.setSize(1,             //channel
+        bufferToFill.buffer.setSize(numChannels,   //channels
             bufferSize,    //num samples
             false,         //keepExistingContent
             true,          //clear extra space
             true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
+        bufferToFill.buffer.clear();
+        bufferToFill.position = 0;
+
+        audioBufferFifo.prepareSlots([numChannels, bufferSize](CapturedBlock& block)
+        {
+            block.buffer.setSize(numChannels, bufferSize, false, true, true);
+            block.buffer.clear();
+            block.position = 0;
+        });
+
         fifoIndex = 0;
+        samplesWritten = 0;
+        writePosition.store(0);
+        droppedBlocks.store(0);
         prepared.set(true);
     }
     //==============================================================================
     int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
+    int getNumChannels() const { return channels.get(); }
+
+    // blocks that were thrown away because the reader didn't keep up (since prepare())
+    juce::int64 getNumDroppedBlocks() const { return droppedBlocks.load(); }
+    // how many samples have been captured (since prepare())
+    juce::int64 getWritePosition() const { return writePosition.load(); }
     //==============================================================================
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+    // zero-copy: calls 'callback' with the oldest complete block, straight out of the ring
+    // a reader that expects 'position' and gets something later has missed (position - expected) samples
+    template<typename Callback>
+    bool readBlock(Callback&& callback) { return audioBufferFifo.pullInPlace(std::forward<Callback>(callback)); }
 private:
-    Channel channelToUse;
     int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
+    juce::int64 samplesWritten = 0;     // only touched by the audio thread
+    Fifo<CapturedBlock, numSlots> audioBufferFifo;
+    CapturedBlock bufferToFill;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
+    juce::Atomic<int> channels = 0;
+    std::atomic<juce::int64> writePosition{ 0 };
+    std::atomic<juce::int64> droppedBlocks{ 0 };
 
-    void pushNextSampleIntoFifo(float sample)
+    void publishBlock(juce::int64 nextBlockPosition)
     {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
-
-            fifoIndex = 0;
-        }
+        // every block in the ring was prepared with the same size, so swapping is safe
+        // if the ring is full the block is dropped (and counted), bufferToFill just gets overwritten
+        if ( ! audioBufferFifo.pushBySwapping(bufferToFill) )
+            droppedBlocks.fetch_add(1);
 
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
+        bufferToFill.position = nextBlockPosition;
+        fifoIndex = 0;
     }
 };
 /**************************************************************************/
@@ -188,11 +412,16 @@ struct ChainSettings
 
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-using Filter = juce::dsp::IIR::Filter<float>;
+// the whole chain is templated on the sample type
+// float for the editor / single precision hosts, double for hosts running in 64-bit
+template<typename SampleType>
+using Filter = juce::dsp::IIR::Filter<SampleType>;
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+template<typename SampleType>
+using CutFilter = juce::dsp::ProcessorChain<Filter<SampleType>, Filter<SampleType>, Filter<SampleType>, Filter<SampleType>>;
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+template<typename SampleType>
+using MonoChain = juce::dsp::ProcessorChain<CutFilter<SampleType>, Filter<SampleType>, CutFilter<SampleType>>;
 
 enum ChainPositions
 {
@@ -201,10 +430,41 @@ enum ChainPositions
     HighCut
 };
 
-using Coefficients = Filter::CoefficientsPtr; /** CoefficientsPtr: A typedef for a ref-counted pointer to the coefficients object */
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+/** CoefficientsPtr: A typedef for a ref-counted pointer to the coefficients object */
+// spelled out (instead of Filter<SampleType>::CoefficientsPtr) so SampleType can be deduced
+template<typename SampleType>
+using Coefficients = juce::ReferenceCountedObjectPtr<juce::dsp::IIR::Coefficients<SampleType>>;
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+template<typename SampleType>
+void updateCoefficients(Coefficients<SampleType>& old, const Coefficients<SampleType>& replacements)
+{
+    *old = *replacements;
+}
+
+// plain-array coefficients: b0 b1 b2 a0 a1 a2 (same layout as juce::dsp::IIR::ArrayCoefficients)
+// copying these into an existing Coefficients object doesn't allocate,
+// so this is what the audio thread uses
+template<typename SampleType>
+using BiquadCoefficients = std::array<SampleType, 6>;
+
+template<typename SampleType>
+using CutCoefficients = std::array<BiquadCoefficients<SampleType>, 4>;
+
+template<typename SampleType>
+void updateCoefficients(Coefficients<SampleType>& old, const BiquadCoefficients<SampleType>& replacements)
+{
+    // Coefficients::operator= (std::array) reuses the existing storage
+    *old = replacements;
+}
+
+template<typename SampleType>
+Coefficients<SampleType> makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate,
+                                                                    chainSettings.peakFreq,
+                                                                    chainSettings.peakQuality,
+                                                                    juce::Decibels::decibelsToGain((SampleType)chainSettings.peakGainInDecibels));
+}
 
 
 // template function update
@@ -262,26 +522,310 @@ void updateCutFilter(ChainType& chain,
     }
 }
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename SampleType>
+auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                       sampleRate,
-                                                                                       2 * (chainSettings.lowCutSlope + 1));
+    return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
+                                                                                            sampleRate,
+                                                                                            2 * (chainSettings.lowCutSlope + 1));
 }
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename SampleType>
+auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                                      sampleRate,
-                                                                                      2 * (chainSettings.highCutSlope + 1));
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
+                                                                                           sampleRate,
+                                                                                           2 * (chainSettings.highCutSlope + 1));
 }
 
+// allocation-free versions of makePeakFilter / makeLowCutFilter / makeHighCutFilter
+// they produce exactly the same coefficients, but into plain arrays
+// instead of new ref-counted objects (+ the ReferenceCountedArray of FilterDesign)
+// (instantiated for float and double in PluginProcessor.cpp)
+template<typename SampleType>
+BiquadCoefficients<SampleType> designPeakFilter(const ChainSettings& chainSettings, double sampleRate);
+template<typename SampleType>
+CutCoefficients<SampleType> designLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
+template<typename SampleType>
+CutCoefficients<SampleType> designHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
+
+// change detection
+// true if something that affects this band is different between the two settings
+bool peakSettingsChanged(const ChainSettings& a, const ChainSettings& b);
+bool lowCutSettingsChanged(const ChainSettings& a, const ChainSettings& b);
+bool highCutSettingsChanged(const ChainSettings& a, const ChainSettings& b);
+
+// the kind of sections the processing engine runs (the "Filter Topology" parameter)
+enum FilterTopology
+{
+    TransposedDirectForm2, // biquads, same arithmetic as juce::dsp::IIR::Filter
+    StateVariable          // TPT state variable filters, stay accurate at low cutoffs / high sample rates in float
+};
+
+// TPT state variable filter coefficients: a1 a2 a3 m0 m1 m2
+// the design is done in double and only rounded at the end,
+// so the low cutoff precision problem of the biquad form doesn't show up here
+template<typename SampleType>
+using SVFCoefficients = std::array<SampleType, 6>;
+
+template<typename SampleType>
+using CutSVFCoefficients = std::array<SVFCoefficients<SampleType>, 4>;
+
+template<typename SampleType>
+SVFCoefficients<SampleType> designPeakSVF(const ChainSettings& chainSettings, double sampleRate);
+template<typename SampleType>
+CutSVFCoefficients<SampleType> designLowCutSVF(const ChainSettings& chainSettings, double sampleRate);
+template<typename SampleType>
+CutSVFCoefficients<SampleType> designHighCutSVF(const ChainSettings& chainSettings, double sampleRate);
+
+// a complete coefficient set for one MonoChain
+// designed off the audio thread, applied on it
+// only the arrays of 'topology' are filled
+template<typename SampleType>
+struct ChainCoefficients
+{
+    ChainSettings settings;
+    FilterTopology topology{ FilterTopology::TransposedDirectForm2 };
+
+    BiquadCoefficients<SampleType> peak{};
+    CutCoefficients<SampleType> lowCut{}, highCut{};
+
+    SVFCoefficients<SampleType> peakSVF{};
+    CutSVFCoefficients<SampleType> lowCutSVF{}, highCutSVF{};
+};
+
+template<typename SampleType>
+ChainCoefficients<SampleType> designChainCoefficients(const ChainSettings& chainSettings,
+                                                      double sampleRate,
+                                                      FilterTopology topology = FilterTopology::TransposedDirectForm2);
+
+// (re)designs one band from chainCoefficients.settings, for chainCoefficients.topology
+template<typename SampleType>
+void designBand(ChainCoefficients<SampleType>& chainCoefficients, ChainPositions band, double sampleRate);
+
+// copies a design into the chain's existing coefficient objects (no allocation)
+template<typename SampleType>
+void applyChainCoefficients(MonoChain<SampleType>& chain, const ChainCoefficients<SampleType>& chainCoefficients);
+
+/*************************************************************************/
+// magnitude response of a design (TransposedDirectForm2 coefficients) on a fixed frequency grid
+// for drawing: the editor's response curve, thumbnails, offline checks
+// cos/sin of w and 2w are computed once in prepare(), after that a biquad is
+// a few multiply-adds on juce::dsp::SIMDRegister<double>, several frequencies at a time,
+// and a whole band / chain needs one division and one log per frequency
+// instead of a complex exp per biquad per frequency (getMagnitudeForFrequency)
+struct FrequencyResponseEvaluator
+{
+    // 'frequencies' in Hz, any spacing
+    void prepare(const double* frequencies, int numFrequencies, double sampleRate);
+    // the response curve's grid: mapToLog10(i / numPoints, minFreq, maxFreq), i = 0 .. numPoints - 1
+    void prepareLogGrid(int numPoints, double sampleRate, double minFreq = 20.0, double maxFreq = 20000.0);
+
+    int getNumFrequencies() const { return numFrequencies; }
+    double getSampleRate() const { return sampleRate; }
+
+    // 20 * log10 |H| for every frequency of the grid (floored at -100dB like juce::Decibels)
+    // a bypassed band is 0dB
+    template<typename SampleType>
+    void getBandDecibels(const ChainCoefficients<SampleType>& chainCoefficients, ChainPositions band, double* decibels);
+    template<typename SampleType>
+    void getChainDecibels(const ChainCoefficients<SampleType>& chainCoefficients, double* decibels);
+private:
+    using SIMDType = juce::dsp::SIMDRegister<double>;
+
+    template<typename SampleType>
+    void multiplyPower(const BiquadCoefficients<SampleType>& biquad);
+    template<typename SampleType>
+    void multiplyBandPower(const ChainCoefficients<SampleType>& chainCoefficients, ChainPositions band);
+    void resetPower();
+    void powerToDecibels(double* decibels) const;
+
+    // the grid, SIMDType::size() frequencies per register, the last one padded with w = 0
+    std::vector<SIMDType> cosW, sinW, cos2W, sin2W;
+    // |numerator|^2 and |denominator|^2 of everything multiplied in so far
+    // (kept apart so the SIMD loop has no division, they're divided once in powerToDecibels)
+    std::vector<SIMDType> numeratorPower, denominatorPower;
+    int numFrequencies = 0;
+    double sampleRate = 0.0;
+};
+
+/*************************************************************************/
+// parameter smoothing
+// ramps Peak Freq/Gain/Quality and the cut frequencies towards the latest design
+// instead of jumping to it (zipper noise under fast automation)
+// while a ramp is running, the bands are redesigned every few samples (the stride)
+// with the closed-form biquad formulas; when it's done the designer's coefficients are used as-is
+template<typename SampleType>
+struct ChainSmoother
+{
+    void prepare(double sampleRate, double rampLengthSeconds);
+
+    // jump straight to a design, no ramp
+    void reset(const ChainCoefficients<SampleType>& chainCoefficients);
+
+    // start ramping towards a new design
+    // slopes and bypass states aren't continuous, they switch immediately
+    void setTarget(const ChainCoefficients<SampleType>& chainCoefficients);
+
+    bool isSmoothing() const { return pendingBands != 0; }
+
+    // designs the coefficients for the next numSamples and moves the ramps on
+    // returns the bands (1 << ChainPositions) that were written into 'result'
+    int process(int numSamples, ChainCoefficients<SampleType>& result);
+private:
+    // the parameters themselves are floats, whatever we process in
+    using FrequencySmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using GainSmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    FrequencySmoother peakFreq, peakQuality, lowCutFreq, highCutFreq;
+    GainSmoother peakGain;
+
+    ChainCoefficients<SampleType> target;
+    double sampleRate{ 44100.0 };
+    int pendingBands{ 0 };
+};
+
+/*************************************************************************/
+// the coefficient designer
+// listens to the parameters and runs the filter design on its own thread
+// the finished ChainCoefficients are handed to the audio thread through a LatestValueSlot,
+// so processBlock only has to swap them in at the start of a block
+// it designs for one sample type at a time, the one it was last prepared with
+struct CoefficientDesigner : juce::Thread,
+juce::AudioProcessorParameter::Listener
+{
+    CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts);
+    ~CoefficientDesigner() override;
+
+    // stops the thread, designs the current settings synchronously and starts the thread again
+    // call this from prepareToPlay (i.e. while the audio thread isn't pulling)
+    template<typename SampleType>
+    ChainCoefficients<SampleType> prepare(double sampleRate, FilterTopology topology);
+    void release();
+
+    // audio thread: true if a new design was published since the last call
+    template<typename SampleType>
+    bool getNewCoefficients(ChainCoefficients<SampleType>& chainCoefficients) { return getSlot<SampleType>().pull(chainCoefficients); }
+
+    // these can be called from any thread (including the audio thread during automation)
+    // so they only raise a flag
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override { }
+
+    void run() override;
+private:
+    juce::AudioProcessorValueTreeState& apvts;
+
+    std::atomic<double> sampleRate{ 0.0 };
+    std::atomic<bool> parametersChanged{ false };
+
+    LatestValueSlot<ChainCoefficients<float>> floatSlot;
+    LatestValueSlot<ChainCoefficients<double>> doubleSlot;
+
+    template<typename SampleType>
+    LatestValueSlot<ChainCoefficients<SampleType>>& getSlot()
+    {
+        if constexpr ( std::is_same_v<SampleType, double> )
+            return doubleSlot;
+        else
+            return floatSlot;
+    }
+
+    // only touched by the designer thread (or by prepare() while it is stopped)
+    ChainSettings lastChainSettings;
+    double lastSampleRate{ 0.0 };
+    FilterTopology topology{ FilterTopology::TransposedDirectForm2 };
+    bool doublePrecision{ false };
+
+    // the audio thread can't wake us up (notify() takes a lock), so its changes are polled:
+    // every pollIntervalMs while something changed in the last activePollTimeMs,
+    // otherwise the thread sleeps for idleWaitMs (or until the message thread notifies it)
+    // so an idle instance wakes up ~20 times a second, not 500
+    static constexpr int pollIntervalMs = 2;
+    static constexpr int activePollTimeMs = 500;
+    static constexpr int idleWaitMs = 50;
+    juce::uint32 lastChangeMs{ 0 }; // designer thread
+};
+
+/*************************************************************************/
+// the processing engine
+// a MonoChain flattened into its biquad sections, run for several channels at once:
+// every channel sits in its own lane of a juce::dsp::SIMDRegister, all lanes share the coefficients
+// only the active (not bypassed) sections are run, back to back for every sample
+// with TransposedDirectForm2 the arithmetic is the same as juce::dsp::IIR::Filter, so the output matches the MonoChain
+// with StateVariable every section is a TPT state variable filter with the same response
+template<typename SampleType>
+struct SIMDChain
+{
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+
+    // how many channels one chain can run
+    // float: 4 with SSE/NEON, 8 with AVX. double: half of that
+    static constexpr size_t maxNumChannels = SIMDType::size();
+
+    // LowCut stages 0-3, Peak, HighCut stages 0-3
+    static constexpr int numSections = 9;
+
+    void prepare(int numChannels, int maximumBlockSize, FilterTopology topology);
+    void reset();
+
+    // picks the active sections and normalises their coefficients (no allocation)
+    void setCoefficients(const ChainCoefficients<SampleType>& chainCoefficients);
+
+    // any block size, a block bigger than the prepared one is processed in chunks
+    void process(juce::dsp::AudioBlock<SampleType>& block);
+private:
+    // TransposedDirectForm2: b0 b1 b2 a1 a2 -
+    // StateVariable:         a1 a2 a3 m0 m1 m2
+    struct Section
+    {
+        std::array<SIMDType, 6> c;
+    };
+
+    template<FilterTopology Topology>
+    void processSections(SIMDType* samples, size_t numSamples);
+
+    FilterTopology topology{ FilterTopology::TransposedDirectForm2 };
+
+    std::array<Section, numSections> sections;
+
+    // the filter state lives in fixed slots (like the filters in the MonoChain)
+    // so a stage that gets bypassed and comes back later picks up where it was
+    std::array<SIMDType, numSections> state1, state2;
+
+    std::array<int, numSections> activeSections{};
+    int numActiveSections = 0;
+
+    // channels interleaved: one SIMDType per sample
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<SIMDType> interleaved;
+    size_t numChannelsToProcess = 0;
+};
+
+/*************************************************************************/
+// a choice parameter the host can't automate (e.g. the analyzer FFT size)
+struct NonAutomatableChoice : juce::AudioParameterChoice
+{
+    using juce::AudioParameterChoice::AudioParameterChoice;
+    bool isAutomatable() const override { return false; }
+};
+
+/*************************************************************************/
+// the half-band filters of the optional oversampling stage (the "Oversampling Filter" parameter)
+enum OversamplingFilter
+{
+    PolyphaseIIR,   // cheap, non-linear phase, small latency
+    EquirippleFIR   // linear phase, more CPU and latency
+};
+
 /*************************************************************************/
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -298,6 +842,10 @@ public:
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    // 64-bit hosts hand us double buffers directly, no conversion on every block
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -321,7 +869,21 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // parameter smoothing
+    // how long a ramp takes, and how many samples pass between two coefficient updates during it
+    // (takes effect on the next prepareToPlay)
+    void setParameterSmoothing(double rampLengthSeconds, int coefficientUpdateStride);
+
+    // the sample rate the filters are designed for and run at (host rate * oversampling factor)
+    double getFilterSampleRate() const { return filterSampleRate; }
+
+    // the topology the chains were last prepared with
+    FilterTopology getFilterTopology() const { return filterTopology; }
+
     // my code here
+    // the widest layout we accept (3rd order ambisonics, 7.1.4 is 12)
+    static constexpr int maxNumChannels = 16;
+
     static juce::AudioProcessorValueTreeState::ParameterLayout
         createParameterLayout();
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", 
@@ -330,10 +892,20 @@ public:
     // create a type alias
     using BlockType = juce::AudioBuffer<float>;
     // instances
-    SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left };
-    SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
+    // SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left };
+    // SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
+    // one ring for both channels, written once per block
+    static constexpr int maxNumCaptureChannels = 2;
+    MultiChannelSampleFifo<BlockType> captureFifo;
+
+    // analyzer handshake (message thread): the capture only runs while something reads it
+    // no editor open / analyzer off -> processBlock doesn't copy a thing
+    void addAnalyzerReader() { numAnalyzerReaders.fetch_add(1); }
+    void removeAnalyzerReader() { numAnalyzerReaders.fetch_sub(1); }
+    bool hasAnalyzerReaders() const { return numAnalyzerReaders.load() > 0; }
 
 private:
+    std::atomic<int> numAnalyzerReaders{ 0 };
 
     // my code here
     // let's create some type aliases to eliminate a lot of those namespace and template definitions
@@ -344,19 +916,97 @@ private:
     // we need to give the editor its own instance of the mono chain
     // to do that, we need to make all of the stuff that makes the mono chain public
 
-    MonoChain leftChain, rightChain;
+    // MonoChain leftChain, rightChain;
+    // replaced by a pool of SIMD chains, every channel runs in one lane of one of them
+    // sized in prepareToPlay, never touched by the audio thread
+    // there is one pool per sample type, only the one for the host's precision gets prepared
+    template<typename SampleType>
+    struct ChainPool
+    {
+        std::vector<SIMDChain<SampleType>> chains;
+
+        // ramps towards each new design
+        ChainSmoother<SampleType> smoother;
+
+        // null when oversampling is off
+        std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+    };
+
+    ChainPool<float> floatChains;
+    ChainPool<double> doubleChains;
+
+    template<typename SampleType>
+    ChainPool<SampleType>& getChainPool()
+    {
+        if constexpr ( std::is_same_v<SampleType, double> )
+            return doubleChains;
+        else
+            return floatChains;
+    }
+
+    // reads the engine settings from the parameters, true if any of them changed
+    bool readEngineSettings();
+
+    // (re)builds the pool for the host's precision from the engine settings
+    // the capture fifo is left alone, it only depends on the host rate / block size
+    void prepareEngine(double sampleRate, int samplesPerBlock);
+
+    template<typename SampleType>
+    void prepareChains(double sampleRate, int samplesPerBlock);
+
+    // what prepareToPlay was last called with, a sample rate of 0 = not prepared
+    // an engine setting that changes in between re-prepares with these
+    double preparedSampleRate{ 0.0 };
+    int preparedBlockSize{ 0 };
+
+    // the parameters readEngineSettings() reads
+    static constexpr const char* engineParameterIDs[] = { "Filter Topology", "Oversampling", "Oversampling Filter" };
 
-    // update the coefficients of Peak Filter
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    // refactored Peak coefficient generation
-    // move to the top
-    //using Coefficients = Filter::CoefficientsPtr; /** CoefficientsPtr: A typedef for a ref-counted pointer to the coefficients object */
-    //static void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+    // the engine settings aren't automatable, so these come from the message thread
+    // (the editor, or the host restoring a state), never from processBlock
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    // suspends processing and re-prepares the engine with the new settings
+    void handleAsyncUpdate() override;
 
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    // both processBlock overloads end up here
+    template<typename SampleType>
+    void processBuffer(juce::AudioBuffer<SampleType>& buffer);
 
+    // swaps in the latest design from the coefficient designer (if there is one)
+    template<typename SampleType>
     void updateFilters();
+    template<typename SampleType>
+    void updateFilters(const ChainCoefficients<SampleType>& chainCoefficients);
+
+    // designs the coefficients off the audio thread
+    CoefficientDesigner coefficientDesigner{ apvts };
+
+    // the kind of filter sections the chains run
+    // read from the "Filter Topology" parameter in prepareToPlay, and again when it changes
+    FilterTopology filterTopology{ FilterTopology::TransposedDirectForm2 };
+
+    double smoothingRampLengthSeconds{ 0.05 };
+    int coefficientUpdateStride{ 32 };
+    template<typename SampleType>
+    void updateSmoothedFilters(int numSamples);
+
+    // oversampling settings ("Oversampling", "Oversampling Filter", read in prepareToPlay and again when they change),
+    // and what prepareChains made of them
+    // the chains run at 2^oversamplingStages times the host rate: 0 = off, 1 = 2x, 2 = 4x, 3 = 8x
+    // the latency of the half-band filters is reported to the host
+    int oversamplingStages{ 0 };
+    OversamplingFilter oversamplingFilter{ OversamplingFilter::PolyphaseIIR };
+    int oversamplingFactor{ 1 };
+    size_t oversamplingBlockSize{ 1 }; // the most host samples the oversampler takes in one go
+    double filterSampleRate{ 44100.0 };
+    double tailLengthSeconds{ 0.0 };
+
+    // runs the chains over a block at the filter sample rate, with the smoothing sub-blocks
+    template<typename SampleType>
+    void processSmoothed(juce::dsp::AudioBlock<SampleType>& block);
+
+    template<typename SampleType>
+    void processChains(juce::dsp::AudioBlock<SampleType>& block);
 
     //juce::dsp::Oscillator<float> osc; // for fft test
 
@@ -370,7 +1020,7 @@ private:
 // Host Buffers X Samples
 //          |
 //   ----------------
-//  | Simple Channel |
+//  | Multi Channel  |
 //  |  Sample fifo   |
 //   ----------------
 //          |
@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    Counts heap allocations (global operator new) on the calling thread.
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+// the count of the innermost counter of this thread, null when nobody is counting
+static thread_local int* currentCount = nullptr;
+
+ScopedAllocationCounter::ScopedAllocationCounter() :
+previousCount(currentCount)
+{
+    currentCount = &numAllocations;
+}
+
+ScopedAllocationCounter::~ScopedAllocationCounter()
+{
+    currentCount = previousCount;
+}
+
+static void* allocate(std::size_t size)
+{
+    if ( currentCount != nullptr )
+        ++*currentCount;
+
+    if ( auto* p = std::malloc(size > 0 ? size : 1) )
+        return p;
+
+    throw std::bad_alloc();
+}
+
+// the sized / nothrow forms end up in these
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    Counts heap allocations (global operator new) on the calling thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// every operator new made by this thread while the counter is alive is counted
+// other threads aren't, so a test can let them allocate freely
+// (juce::HeapBlock uses malloc directly and isn't seen, everything using new is)
+struct ScopedAllocationCounter
+{
+    ScopedAllocationCounter();
+    ~ScopedAllocationCounter();
+
+    int getNumAllocations() const { return numAllocations; }
+private:
+    int numAllocations = 0;
+    int* previousCount = nullptr;
+};
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    analyzer (editor side) tests
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginEditor.h"
+
+#include <algorithm>
+#include <limits>
+
+//==============================================================================
+// the SIMD dB conversion against the two loops it replaced
+struct MagnitudesToDecibelsTest : juce::UnitTest
+{
+    MagnitudesToDecibelsTest() : juce::UnitTest("magnitudesToDecibels", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr float negativeInfinity = -48.f;
+        juce::Random random(15);
+
+        // 1027: the SIMD loop plus a scalar tail of 3
+        for (auto numBins : { 1027, 1 << FFTOrder::order2048, 1 << FFTOrder::order8192 })
+        {
+            beginTest(juce::String(numBins) + " bins");
+
+            std::vector<float> data((size_t)numBins);
+            for (auto& v : data)
+                v = std::pow(10.f, random.nextFloat() * 12.f - 6.f);
+
+            data[0] = 0.f;
+            data[1] = std::numeric_limits<float>::infinity();
+            data[2] = std::numeric_limits<float>::quiet_NaN();
+            data[3] = std::numeric_limits<float>::denorm_min();
+            data[(size_t)numBins - 1] = std::numeric_limits<float>::infinity(); // in the tail for 1027
+            data[(size_t)numBins - 2] = std::numeric_limits<float>::quiet_NaN();
+
+            auto expected = data;
+            for (auto& v : expected)
+            {
+                v = (std::isinf(v) || std::isnan(v)) ? 0.f : v / float(numBins);
+                v = juce::Decibels::gainToDecibels(v, negativeInfinity);
+            }
+
+            magnitudesToDecibels(data.data(), numBins, negativeInfinity);
+
+            float maxError = 0.f;
+            for (size_t i = 0; i < data.size(); ++i)
+                maxError = juce::jmax(maxError, std::abs(data[i] - expected[i]));
+
+            // fastLog2 is good to ~1.7e-5, i.e. ~1e-4 dB
+            expectLessThan(maxError, 1.0e-3f);
+
+            for (auto i : { 0, 1, 2, 3, numBins - 2, numBins - 1 })
+                expectEquals(data[(size_t)i], negativeInfinity);
+        }
+    }
+};
+
+static MagnitudesToDecibelsTest magnitudesToDecibelsTest;
+
+//==============================================================================
+// a sine in the middle of each level's octave has to peak on its own column of the 20Hz..20kHz axis,
+// whichever decimated level ends up drawing it
+struct MultiResolutionColumnsTest : juce::UnitTest
+{
+    MultiResolutionColumnsTest() : juce::UnitTest("MultiResolutionAnalyzer columns", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr float negativeInfinity = -48.f;
+        constexpr int numColumns = 1000;
+        constexpr int hostBlockSize = 480;
+
+        FFTPlans plans;
+        MultiResolutionAnalyzer analyzer(plans);
+        std::vector<float> columnLevels((size_t)numColumns);
+        std::vector<float> sine;
+
+        for (auto sampleRate : { 48000.0, 96000.0 })
+        {
+            // same count as MultiResolutionAnalyzer::prepare
+            const auto numLevels = 1 + (int)std::ceil(std::log2(sampleRate / (12.0 * 20.0)));
+
+            for (int level = 0; level < numLevels; ++level)
+            {
+                // level k shows [fs_k / 12, fs_k / 6]
+                const auto frequency = sampleRate / (1 << level) / 12.0 * juce::MathConstants<double>::sqrt2;
+                beginTest(juce::String(sampleRate / 1000.0) + "kHz, level " + juce::String(level) + ": " + juce::String(frequency, 1) + "Hz");
+
+                // enough for the deepest level's window to fill up (2.7s at 48kHz)
+                sine.resize((size_t)(3.0 * sampleRate));
+                for (size_t i = 0; i < sine.size(); ++i)
+                    sine[i] = (float)std::sin(juce::MathConstants<double>::twoPi * frequency * (double)i / sampleRate);
+
+                analyzer.prepare(sampleRate, negativeInfinity);
+                for (int start = 0; start < (int)sine.size(); start += hostBlockSize)
+                    analyzer.addSamples(sine.data() + start, juce::jmin(hostBlockSize, (int)sine.size() - start), negativeInfinity);
+
+                analyzer.renderColumns(columnLevels, numColumns);
+
+                const auto peakColumn = (int)std::distance(columnLevels.begin(), std::max_element(columnLevels.begin(), columnLevels.end()));
+                const auto peakLevel = columnLevels[(size_t)peakColumn];
+
+                // a Blackman-Harris windowed full scale sine reads about -9dB
+                expectGreaterThan(peakLevel, -12.f);
+
+                // half a bin of every level is about 1/48 octave, plus a column
+                const auto expectedColumn = juce::mapFromLog10(frequency, 20.0, 20000.0) * numColumns;
+                expectLessThan(std::abs(peakColumn + 0.5 - expectedColumn), numColumns * (1.0 / 48.0) / std::log2(1000.0) + 1.0);
+
+                auto getColumnFrequency = [](int column)
+                {
+                    return std::sqrt(juce::mapToLog10((double)column / numColumns, 20.0, 20000.0)
+                                   * juce::mapToLog10((double)(column + 1) / numColumns, 20.0, 20000.0));
+                };
+
+                // nothing shows up more than half an octave away (the other levels, the decimators' images)
+                float farLevel = negativeInfinity;
+                for (int column = 0; column < numColumns; ++column)
+                {
+                    if ( std::abs(std::log2(getColumnFrequency(column) / frequency)) > 0.5 )
+                        farLevel = juce::jmax(farLevel, columnLevels[(size_t)column]);
+                }
+
+                expectLessThan(farLevel, peakLevel - 30.f);
+            }
+        }
+    }
+};
+
+static MultiResolutionColumnsTest multiResolutionColumnsTest;
@@ -0,0 +1,464 @@
+/*
+  ==============================================================================
+
+    timings for the optimised kernels against what they replaced
+    only run with --benchmarks, they log numbers and never fail
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PluginEditor.h"
+
+namespace
+{
+    // average time of one call, in microseconds (after one untimed warm up call)
+    template<typename Function>
+    double timeMicroseconds(int numRuns, Function&& function)
+    {
+        function();
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        for (int run = 0; run < numRuns; ++run)
+            function();
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        return seconds * 1.0e6 / numRuns;
+    }
+
+    juce::String formatComparison(const juce::String& name, double baselineMicroseconds, double microseconds)
+    {
+        return name + ": " + juce::String(baselineMicroseconds, 2) + " us -> " + juce::String(microseconds, 2)
+             + " us (" + juce::String(baselineMicroseconds / microseconds, 2) + "x)";
+    }
+
+    // the heaviest configuration: every section of every band running
+    ChainSettings getAllBandsSettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 40.f;
+        settings.lowCutSlope = Slope::Slope_48;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 1.f;
+        settings.highCutFreq = 12000.f;
+        settings.highCutSlope = Slope::Slope_48;
+        return settings;
+    }
+
+    // what the response curve did before FrequencyResponseEvaluator:
+    // getMagnitudeForFrequency for every active biquad of the chain, one frequency at a time
+    template<typename SampleType>
+    double getMagnitudeForFrequency(MonoChain<SampleType>& chain, double frequency, double sampleRate)
+    {
+        double magnitude = 1.0;
+        auto multiply = [&](auto& filter) { magnitude *= filter.coefficients->getMagnitudeForFrequency(frequency, sampleRate); };
+
+        auto multiplyCut = [&](auto& cut)
+        {
+            if ( ! cut.template isBypassed<0>() ) multiply(cut.template get<0>());
+            if ( ! cut.template isBypassed<1>() ) multiply(cut.template get<1>());
+            if ( ! cut.template isBypassed<2>() ) multiply(cut.template get<2>());
+            if ( ! cut.template isBypassed<3>() ) multiply(cut.template get<3>());
+        };
+
+        if ( ! chain.template isBypassed<ChainPositions::LowCut>() )
+            multiplyCut(chain.template get<ChainPositions::LowCut>());
+        if ( ! chain.template isBypassed<ChainPositions::Peak>() )
+            multiply(chain.template get<ChainPositions::Peak>());
+        if ( ! chain.template isBypassed<ChainPositions::HighCut>() )
+            multiplyCut(chain.template get<ChainPositions::HighCut>());
+
+        return magnitude;
+    }
+
+    template<typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random(4);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, (SampleType)(random.nextFloat() * 2.f - 1.f));
+    }
+}
+
+//==============================================================================
+// one MonoChain per channel (the old engine) against one SIMDChain for all of them
+struct SIMDChainBenchmark : juce::UnitTest
+{
+    SIMDChainBenchmark() : juce::UnitTest("SIMDChain vs MonoChain", "Benchmarks") { }
+
+    void runTest() override
+    {
+        beginTest("stereo, 9 biquads per channel");
+
+        constexpr double sampleRate = 48000.0;
+        constexpr int numRuns = 2000;
+        const auto coefficients = designChainCoefficients<float>(getAllBandsSettings(), sampleRate);
+
+        for (auto blockSize : { 64, 512, 2048 })
+        {
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            fillWithNoise(buffer);
+            juce::dsp::AudioBlock<float> block(buffer);
+
+            std::array<MonoChain<float>, 2> monoChains;
+            for (auto& chain : monoChains)
+            {
+                applyChainCoefficients(chain, coefficients);
+                chain.prepare({ sampleRate, (juce::uint32)blockSize, 1 });
+            }
+
+            const auto monoChainTime = timeMicroseconds(numRuns, [&]
+            {
+                for (size_t ch = 0; ch < monoChains.size(); ++ch)
+                {
+                    auto channel = block.getSingleChannelBlock(ch);
+                    monoChains[ch].process(juce::dsp::ProcessContextReplacing<float>(channel));
+                }
+            });
+
+            SIMDChain<float> simdChain;
+            simdChain.prepare(2, blockSize, FilterTopology::TransposedDirectForm2);
+            simdChain.setCoefficients(coefficients);
+
+            const auto simdChainTime = timeMicroseconds(numRuns, [&] { simdChain.process(block); });
+
+            logMessage(formatComparison(juce::String(blockSize) + " samples", monoChainTime, simdChainTime));
+        }
+    }
+};
+
+static SIMDChainBenchmark simdChainBenchmark;
+
+//==============================================================================
+// processBlock with the oversampling stage at every factor, for both kinds of half-band filters
+struct OversamplingBenchmark : juce::UnitTest
+{
+    OversamplingBenchmark() : juce::UnitTest("Oversampling", "Benchmarks") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numRuns = 500;
+
+        for (auto filter : { 0, 1 })
+        {
+            beginTest(filter == 0 ? "polyphase IIR" : "linear phase FIR");
+
+            double offTime = 0.0;
+            for (auto stages : { 0, 1, 2, 3 })
+            {
+                SimpleEQAudioProcessor processor;
+                for (auto [parameterID, value] : { std::pair<const char*, float>{ "Oversampling", (float)stages },
+                                                   std::pair<const char*, float>{ "Oversampling Filter", (float)filter } })
+                {
+                    auto* parameter = processor.apvts.getParameter(parameterID);
+                    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+                }
+
+                processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor.prepareToPlay(sampleRate, blockSize);
+
+                juce::AudioBuffer<float> buffer(2, blockSize);
+                fillWithNoise(buffer);
+                juce::MidiBuffer midi;
+
+                const auto time = timeMicroseconds(numRuns, [&] { processor.processBlock(buffer, midi); });
+                if ( stages == 0 )
+                    offTime = time;
+
+                logMessage(juce::String(1 << stages) + "x: " + juce::String(time, 2) + " us per "
+                           + juce::String(blockSize) + " sample block (" + juce::String(time / offTime, 2)
+                           + "x the cost of no oversampling), latency " + juce::String(processor.getLatencySamples()) + " samples");
+
+                processor.releaseResources();
+            }
+        }
+    }
+};
+
+static OversamplingBenchmark oversamplingBenchmark;
+
+//==============================================================================
+// the same chain in float and in double: the SIMD kernel alone, and the whole processBlock
+struct PrecisionBenchmark : juce::UnitTest
+{
+    PrecisionBenchmark() : juce::UnitTest("Float vs double", "Benchmarks") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numRuns = 2000;
+
+        beginTest("SIMDChain, stereo, 9 biquads per channel");
+
+        SIMDChain<float> floatChain;
+        floatChain.prepare(2, blockSize, FilterTopology::TransposedDirectForm2);
+        floatChain.setCoefficients(designChainCoefficients<float>(getAllBandsSettings(), sampleRate));
+
+        SIMDChain<double> doubleChain;
+        doubleChain.prepare(2, blockSize, FilterTopology::TransposedDirectForm2);
+        doubleChain.setCoefficients(designChainCoefficients<double>(getAllBandsSettings(), sampleRate));
+
+        juce::AudioBuffer<float> floatBuffer(2, blockSize);
+        juce::AudioBuffer<double> doubleBuffer(2, blockSize);
+        fillWithNoise(floatBuffer);
+        fillWithNoise(doubleBuffer);
+        juce::dsp::AudioBlock<float> floatBlock(floatBuffer);
+        juce::dsp::AudioBlock<double> doubleBlock(doubleBuffer);
+
+        const auto floatTime = timeMicroseconds(numRuns, [&] { floatChain.process(floatBlock); });
+        const auto doubleTime = timeMicroseconds(numRuns, [&] { doubleChain.process(doubleBlock); });
+        logMessage(formatComparison("float -> double", floatTime, doubleTime));
+
+        beginTest("processBlock");
+
+        SimpleEQAudioProcessor floatProcessor, doubleProcessor;
+        doubleProcessor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+        for (auto* processor : { &floatProcessor, &doubleProcessor })
+        {
+            processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor->prepareToPlay(sampleRate, blockSize);
+        }
+
+        juce::MidiBuffer midi;
+        const auto floatBlockTime = timeMicroseconds(numRuns, [&] { floatProcessor.processBlock(floatBuffer, midi); });
+        const auto doubleBlockTime = timeMicroseconds(numRuns, [&] { doubleProcessor.processBlock(doubleBuffer, midi); });
+        logMessage(formatComparison("float -> double", floatBlockTime, doubleBlockTime));
+
+        floatProcessor.releaseResources();
+        doubleProcessor.releaseResources();
+    }
+};
+
+static PrecisionBenchmark precisionBenchmark;
+
+//==============================================================================
+// the response curve: getMagnitudeForFrequency per biquad per pixel against the batch evaluator
+struct FrequencyResponseBenchmark : juce::UnitTest
+{
+    FrequencyResponseBenchmark() : juce::UnitTest("FrequencyResponseEvaluator vs getMagnitudeForFrequency", "Benchmarks") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int numRuns = 200;
+
+        const auto settings = getAllBandsSettings();
+        const auto coefficients = designChainCoefficients<double>(settings, sampleRate);
+
+        // what the editor used to hold
+        MonoChain<float> chain;
+        applyChainCoefficients(chain, designChainCoefficients<float>(settings, sampleRate));
+
+        // a 1000 px curve, a 4K screen, a 4K screen at 2x
+        for (auto width : { 1000, 3840, 7680 })
+        {
+            beginTest(juce::String(width) + " frequencies, 9 biquads");
+
+            std::vector<double> decibels((size_t)width);
+
+            const auto perPixelTime = timeMicroseconds(numRuns, [&]
+            {
+                for (int i = 0; i < width; ++i)
+                {
+                    const auto frequency = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+                    decibels[(size_t)i] = juce::Decibels::gainToDecibels(getMagnitudeForFrequency(chain, frequency, sampleRate));
+                }
+            });
+
+            // prepared once per width / sample rate in the editor, so not timed
+            FrequencyResponseEvaluator evaluator;
+            evaluator.prepareLogGrid(width, sampleRate);
+
+            const auto evaluatorTime = timeMicroseconds(numRuns, [&]
+            {
+                evaluator.getChainDecibels(coefficients, decibels.data());
+            });
+
+            logMessage(formatComparison("per pixel -> evaluator", perPixelTime, evaluatorTime));
+        }
+    }
+};
+
+static FrequencyResponseBenchmark frequencyResponseBenchmark;
+
+//==============================================================================
+// a push + pull through the Fifo: copying, swapping, in place
+// with the analyzer's types (a captured block, an FFT frame, a path)
+struct FifoBenchmark : juce::UnitTest
+{
+    FifoBenchmark() : juce::UnitTest("Fifo", "Benchmarks") { }
+
+    void runTest() override
+    {
+        constexpr int numRuns = 20000;
+
+        beginTest("AudioBuffer<float>, 2 x 2048");
+        {
+            juce::AudioBuffer<float> buffer(2, 2048), result(2, 2048);
+            buffer.clear();
+
+            Fifo<juce::AudioBuffer<float>> fifo;
+            fifo.prepare(2, 2048);
+            run(fifo, buffer, result, numRuns);
+        }
+
+        beginTest("std::vector<float>, 16384 (an FFT frame)");
+        {
+            std::vector<float> frame(16384, 0.f), result(16384, 0.f);
+
+            Fifo<std::vector<float>> fifo;
+            fifo.prepare(frame.size());
+            run(fifo, frame, result, numRuns);
+        }
+
+        beginTest("juce::Path, 1000 points");
+        {
+            juce::Path path, result;
+            path.startNewSubPath(0.f, 0.f);
+            for (int i = 1; i < 1000; ++i)
+                path.lineTo((float)i, (float)(i % 7));
+            result = path;
+
+            Fifo<juce::Path> fifo;
+            fifo.prepareSlots([&path](juce::Path& slot) { slot = path; });
+            run(fifo, path, result, numRuns);
+        }
+    }
+
+    // 'item' and 'result' the same size as the slots, so swapping keeps everything the same size
+    template<typename T>
+    void run(Fifo<T>& fifo, T& item, T& result, int numRuns)
+    {
+        const auto copyTime = timeMicroseconds(numRuns, [&] { fifo.push(item); fifo.pull(result); });
+        const auto swapTime = timeMicroseconds(numRuns, [&] { fifo.pushBySwapping(item); fifo.pullBySwapping(result); });
+        const auto inPlaceTime = timeMicroseconds(numRuns, [&]
+        {
+            fifo.pushInPlace([](T&) { });
+            fifo.pullInPlace([](T&) { });
+        });
+
+        // every push / pull pair with push() / pull() is two deep copies
+        logMessage(formatComparison("copy -> swap", copyTime, swapTime));
+        logMessage(formatComparison("copy -> in place", copyTime, inPlaceTime));
+        logMessage("deep copies avoided: " + juce::String(2.0e6 / copyTime, 0) + " per second at the copying rate");
+    }
+};
+
+static FifoBenchmark fifoBenchmark;
+
+//==============================================================================
+// the SIMD dB conversion against the isinf/isnan + gainToDecibels loops it replaced
+struct DecibelConversionBenchmark : juce::UnitTest
+{
+    DecibelConversionBenchmark() : juce::UnitTest("magnitudesToDecibels", "Benchmarks") { }
+
+    void runTest() override
+    {
+        constexpr float negativeInfinity = -48.f;
+        constexpr int numRuns = 20000;
+        juce::Random random(15);
+
+        for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192 })
+        {
+            const auto numBins = 1 << order;
+            beginTest(juce::String(numBins) + " bins");
+
+            std::vector<float> magnitudes((size_t)numBins), data((size_t)numBins);
+            for (auto& v : magnitudes)
+                v = std::pow(10.f, random.nextFloat() * 12.f - 6.f);
+
+            // both include refreshing the input, it's the same memcpy for both
+            const auto loopsTime = timeMicroseconds(numRuns, [&]
+            {
+                data = magnitudes;
+                for (auto& v : data)
+                    v = (std::isinf(v) || std::isnan(v)) ? 0.f : v / float(numBins);
+                for (auto& v : data)
+                    v = juce::Decibels::gainToDecibels(v, negativeInfinity);
+            });
+
+            const auto simdTime = timeMicroseconds(numRuns, [&]
+            {
+                data = magnitudes;
+                magnitudesToDecibels(data.data(), numBins, negativeInfinity);
+            });
+
+            logMessage(formatComparison("gainToDecibels loops -> magnitudesToDecibels", loopsTime, simdTime));
+        }
+    }
+};
+
+static DecibelConversionBenchmark decibelConversionBenchmark;
+
+//==============================================================================
+// the analyzer thread's work for one second of audio:
+// a 2048 point FFT every 1024 samples (what the fixed-order path does) against the multi-resolution levels
+struct MultiResolutionBenchmark : juce::UnitTest
+{
+    MultiResolutionBenchmark() : juce::UnitTest("MultiResolutionAnalyzer", "Benchmarks") { }
+
+    void runTest() override
+    {
+        constexpr float negativeInfinity = -48.f;
+        constexpr int numRuns = 20;
+        constexpr int hostBlockSize = 480;
+
+        FFTPlans plans;
+
+        for (auto sampleRate : { 48000.0, 96000.0 })
+        {
+            beginTest("1s at " + juce::String(sampleRate / 1000.0) + "kHz, " + juce::String(hostBlockSize) + " sample blocks");
+
+            juce::AudioBuffer<float> audio(1, (int)sampleRate);
+            fillWithNoise(audio);
+            const auto* samples = audio.getReadPointer(0);
+
+            // the ring / hop bookkeeping of PathProducer::addSamples
+            FFTDataGenerator<std::vector<float>> generator(plans);
+            constexpr int fftSize = 1 << FFTOrder::order2048;
+            constexpr int hopSize = fftSize / 2;
+            std::vector<float> ring(fftSize, 0.f);
+            int ringWriteIndex = 0, samplesUntilNextFFT = hopSize;
+
+            const auto overlapTime = timeMicroseconds(numRuns, [&]
+            {
+                for (int i = 0; i < audio.getNumSamples(); ++i)
+                {
+                    ring[(size_t)ringWriteIndex] = samples[i];
+                    ringWriteIndex = (ringWriteIndex + 1) % fftSize;
+
+                    if ( --samplesUntilNextFFT == 0 )
+                    {
+                        samplesUntilNextFFT = hopSize;
+                        generator.produceFFTDataForRendering(ring.data(), ringWriteIndex, negativeInfinity);
+                        generator.readFFTData([](std::vector<float>&) { });
+                    }
+                }
+            });
+
+            MultiResolutionAnalyzer analyzer(plans);
+            analyzer.prepare(sampleRate, negativeInfinity);
+
+            const auto multiResolutionTime = timeMicroseconds(numRuns, [&]
+            {
+                for (int start = 0; start < audio.getNumSamples(); start += hostBlockSize)
+                    analyzer.addSamples(samples + start, juce::jmin(hostBlockSize, audio.getNumSamples() - start), negativeInfinity);
+            });
+
+            logMessage(formatComparison("2048 / 50% overlap -> multi-resolution", overlapTime, multiResolutionTime));
+
+            // what the two of them resolve at the bottom of the axis (the deepest level, see MultiResolutionAnalyzer::prepare)
+            const auto deepestLevel = (int)std::ceil(std::log2(sampleRate / (12.0 * 20.0)));
+            const auto deepestBinWidth = sampleRate / (1 << deepestLevel) / MultiResolutionAnalyzer::fftSize;
+            logMessage("bin width at 20Hz: " + juce::String(sampleRate / fftSize, 2) + " Hz -> " + juce::String(deepestBinWidth, 2) + " Hz");
+        }
+    }
+};
+
+static MultiResolutionBenchmark multiResolutionBenchmark;
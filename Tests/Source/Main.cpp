@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    SimpleEQ tests: runs every juce::UnitTest linked in.
+    the "Benchmarks" category only runs with --benchmarks (they take a while
+    and only print timings), the exit code is the number of failures
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+int main(int argc, char* argv[])
+{
+    // the processor / editor need a message manager, this thread is the message thread
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args(argv + 1, argc - 1);
+    const auto runBenchmarks = args.contains("--benchmarks");
+
+    juce::Array<juce::UnitTest*> tests;
+    for (auto* test : juce::UnitTest::getAllTests())
+    {
+        if ( (test->getCategory() == "Benchmarks") == runBenchmarks )
+            tests.add(test);
+    }
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTests(tests);
+
+    int numFailures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+
+    return numFailures;
+}
@@ -0,0 +1,1083 @@
+/*
+  ==============================================================================
+
+    SimpleEQAudioProcessor tests
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "AllocationCounter.h"
+
+#include <thread>
+
+namespace
+{
+    template<typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = SampleType(random.nextFloat() * 2.f - 1.f);
+        }
+    }
+
+    // a sine per channel, 'position' = the first sample's index
+    template<typename SampleType>
+    void fillWithSines(juce::AudioBuffer<SampleType>& buffer, juce::int64 position, double sampleRate)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const auto frequency = 110.0 * (ch + 1);
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = (SampleType)std::sin(juce::MathConstants<double>::twoPi * frequency * double(position + i) / sampleRate);
+        }
+    }
+
+    template<typename SampleType>
+    bool isFinite(const juce::AudioBuffer<SampleType>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                if ( ! std::isfinite(buffer.getSample(ch, i)) )
+                    return false;
+
+        return true;
+    }
+
+    template<typename SampleType>
+    SampleType getMaxDifference(const juce::AudioBuffer<SampleType>& a, const juce::AudioBuffer<SampleType>& b)
+    {
+        SampleType difference = 0;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                difference = juce::jmax(difference, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+
+        return difference;
+    }
+
+    // what the response curve did before FrequencyResponseEvaluator:
+    // getMagnitudeForFrequency for every active biquad of the chain, one frequency at a time
+    template<typename SampleType>
+    double getMagnitudeForFrequency(MonoChain<SampleType>& chain, double frequency, double sampleRate)
+    {
+        double magnitude = 1.0;
+        auto multiply = [&](auto& filter) { magnitude *= filter.coefficients->getMagnitudeForFrequency(frequency, sampleRate); };
+
+        auto multiplyCut = [&](auto& cut)
+        {
+            if ( ! cut.template isBypassed<0>() ) multiply(cut.template get<0>());
+            if ( ! cut.template isBypassed<1>() ) multiply(cut.template get<1>());
+            if ( ! cut.template isBypassed<2>() ) multiply(cut.template get<2>());
+            if ( ! cut.template isBypassed<3>() ) multiply(cut.template get<3>());
+        };
+
+        if ( ! chain.template isBypassed<ChainPositions::LowCut>() )
+            multiplyCut(chain.template get<ChainPositions::LowCut>());
+        if ( ! chain.template isBypassed<ChainPositions::Peak>() )
+            multiply(chain.template get<ChainPositions::Peak>());
+        if ( ! chain.template isBypassed<ChainPositions::HighCut>() )
+            multiplyCut(chain.template get<ChainPositions::HighCut>());
+
+        return magnitude;
+    }
+
+    // real-world value, like a host would automate it
+    void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // something that affects every band
+    void setTestSettings(SimpleEQAudioProcessor& processor)
+    {
+        setParameter(processor, "LowCut Freq", 100.f);
+        setParameter(processor, "LowCut Slope", 1.f);
+        setParameter(processor, "Peak Freq", 1000.f);
+        setParameter(processor, "Peak Gain", 6.f);
+        setParameter(processor, "Peak Quality", 1.f);
+        setParameter(processor, "HighCut Freq", 8000.f);
+        setParameter(processor, "HighCut Slope", 0.f);
+        setParameter(processor, "LowCut Bypassed", 0.f);
+        setParameter(processor, "Peak Bypassed", 0.f);
+        setParameter(processor, "HighCut Bypassed", 0.f);
+    }
+
+    // runs sines through the processor until the filters have settled, leaves the last block in 'buffer'
+    template<typename SampleType>
+    void processSines(SimpleEQAudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, double sampleRate, double seconds)
+    {
+        juce::MidiBuffer midi;
+        const auto numBlocks = juce::roundToInt(seconds * sampleRate / buffer.getNumSamples());
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillWithSines(buffer, (juce::int64)block * buffer.getNumSamples(), sampleRate);
+            processor.processBlock(buffer, midi);
+        }
+    }
+}
+
+//==============================================================================
+// the audio thread only swaps in designs the CoefficientDesigner finished:
+// no locks, no allocation, however fast the parameters move
+struct AutomationFloodTest : juce::UnitTest
+{
+    AutomationFloodTest() : juce::UnitTest("Automation flood", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+
+        SimpleEQAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(1);
+
+        beginTest("processBlock doesn't allocate or stall while another thread automates every parameter");
+
+        // host automation: the changes come from a thread that isn't the message thread,
+        // so the designer doesn't get notified and has to poll
+        std::atomic<bool> keepAutomating{ true };
+        std::thread automation([&processor, &keepAutomating]
+        {
+            juce::Random r(2);
+            const juce::StringArray parameterIDs{ "LowCut Freq", "LowCut Slope", "LowCut Bypassed",
+                                                  "Peak Freq", "Peak Gain", "Peak Quality", "Peak Bypassed",
+                                                  "HighCut Freq", "HighCut Slope", "HighCut Bypassed" };
+
+            while ( keepAutomating.load() )
+            {
+                for (auto& parameterID : parameterIDs)
+                    processor.apvts.getParameter(parameterID)->setValueNotifyingHost(r.nextFloat());
+            }
+
+            // where the automation stops
+            setTestSettings(processor);
+        });
+
+        int numAllocations = 0;
+        double worstBlockMs = 0.0;
+        bool outputIsFinite = true;
+        const auto endTime = juce::Time::getMillisecondCounter() + 1000;
+
+        // about a second of blocks, long enough for plenty of designs to come through
+        while ( juce::Time::getMillisecondCounter() < endTime )
+        {
+            fillWithNoise(buffer, random);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            {
+                ScopedAllocationCounter allocations;
+                processor.processBlock(buffer, midi);
+                numAllocations += allocations.getNumAllocations();
+            }
+            const auto blockMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+            worstBlockMs = juce::jmax(worstBlockMs, blockMs);
+
+            outputIsFinite = outputIsFinite && isFinite(buffer);
+            std::this_thread::yield();
+        }
+
+        keepAutomating = false;
+        automation.join();
+
+        expectEquals(numAllocations, 0, "processBlock allocated");
+        expect(outputIsFinite, "processBlock produced inf / nan");
+
+        // the designer hands over through a wait-free slot, so no block waits for it:
+        // even the worst block has to meet its deadline (its own length), with two other threads busy
+        // (waiting on a lock the designer holds while it designs would cost designs and scheduler slices)
+        const auto blockLengthMs = blockSize / sampleRate * 1000.0;
+        logMessage("worst processBlock: " + juce::String(worstBlockMs, 3) + " ms for "
+                   + juce::String(blockLengthMs, 2) + " ms of audio");
+        expectLessThan(worstBlockMs, blockLengthMs, "a block missed its real-time deadline");
+
+        beginTest("the audio thread ends up with the last automated values");
+
+        // the designer polls, the smoother ramps: give both time to finish
+        for (int i = 0; i < 300; ++i)
+        {
+            fillWithNoise(buffer, random);
+            processor.processBlock(buffer, midi);
+            juce::Thread::sleep(1);
+        }
+
+        SimpleEQAudioProcessor reference;
+        setTestSettings(reference);
+        reference.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        reference.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> expected(2, blockSize);
+        processSines(reference, expected, sampleRate, 2.0);
+        processSines(processor, buffer, sampleRate, 2.0);
+
+        expectLessThan(getMaxDifference(buffer, expected), 1.0e-4f);
+
+        processor.releaseResources();
+        reference.releaseResources();
+    }
+};
+
+static AutomationFloodTest automationFloodTest;
+
+//==============================================================================
+// the SIMD engine against the MonoChain it replaced: same coefficients, same arithmetic
+struct SIMDChainTest : juce::UnitTest
+{
+    SIMDChainTest() : juce::UnitTest("SIMDChain", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.lowCutSlope = Slope::Slope_48;
+        settings.peakFreq = 1200.f;
+        settings.peakGainInDecibels = -9.f;
+        settings.peakQuality = 2.f;
+        settings.highCutFreq = 9000.f;
+        settings.highCutSlope = Slope::Slope_36;
+
+        const auto coefficients = designChainCoefficients<float>(settings, sampleRate);
+
+        // more than the prepared block size, and not a multiple of it
+        juce::AudioBuffer<float> input(2, blockSize * 3 + 17);
+        juce::Random random(3);
+        fillWithNoise(input, random);
+
+        beginTest("two MonoChains and one SIMDChain give the same output");
+
+        juce::AudioBuffer<float> expected(input);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            MonoChain<float> chain;
+            applyChainCoefficients(chain, coefficients);
+            chain.prepare({ sampleRate, (juce::uint32)expected.getNumSamples(), 1 });
+
+            juce::dsp::AudioBlock<float> block(expected);
+            auto channel = block.getSingleChannelBlock((size_t)ch);
+            chain.process(juce::dsp::ProcessContextReplacing<float>(channel));
+        }
+
+        SIMDChain<float> simdChain;
+        simdChain.prepare(2, blockSize, FilterTopology::TransposedDirectForm2);
+        simdChain.setCoefficients(coefficients);
+
+        juce::AudioBuffer<float> output(input);
+        juce::dsp::AudioBlock<float> block(output);
+        simdChain.process(block);
+
+        // only the denormal flushing at the chunk ends can differ
+        expectLessThan(getMaxDifference(output, expected), 1.0e-6f);
+
+        beginTest("a block bigger than the prepared size is filtered all the way through");
+
+        // the last chunk would have passed through unfiltered before
+        auto tail = output.getNumSamples() - 17;
+        juce::AudioBuffer<float> inputTail(input.getArrayOfWritePointers(), 2, tail, 17);
+        juce::AudioBuffer<float> outputTail(output.getArrayOfWritePointers(), 2, tail, 17);
+        expectGreaterThan(getMaxDifference(outputTail, inputTail), 1.0e-3f);
+    }
+};
+
+static SIMDChainTest simdChainTest;
+
+//==============================================================================
+// more channels than one SIMD register has lanes: a pool of chains, the last one partly used
+// every channel has to come out exactly as if it ran on its own
+struct ChainPoolTest : juce::UnitTest
+{
+    ChainPoolTest() : juce::UnitTest("SIMDChain pool", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        for (auto numChannels : { 5, 7 })
+        {
+            beginTest(juce::String(numChannels) + " channels, float: every lane matches a mono processor");
+            run<float>(numChannels);
+
+            beginTest(juce::String(numChannels) + " channels, double: every lane matches a mono processor");
+            run<double>(numChannels);
+        }
+    }
+
+    template<typename SampleType>
+    void run(int numChannels)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+        constexpr int hostBlockSize = 100;
+        constexpr int numBlocks = 7;
+
+        // different audio in every channel, so a lane mix-up shows
+        juce::AudioBuffer<SampleType> input(numChannels, hostBlockSize * numBlocks);
+        juce::Random random(numChannels);
+        fillWithNoise(input, random);
+
+        auto prepare = [&](SimpleEQAudioProcessor& processor, int channels)
+        {
+            juce::AudioProcessor::BusesLayout layout;
+            // mono, 5.0, 7.0 like a host would hand them to us
+            layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(channels));
+            layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(channels));
+            expect(processor.setBusesLayout(layout));
+
+            if constexpr ( std::is_same_v<SampleType, double> )
+                processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+            setTestSettings(processor);
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+        };
+
+        auto process = [](SimpleEQAudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer)
+        {
+            juce::MidiBuffer midi;
+            for (int start = 0; start < buffer.getNumSamples(); start += hostBlockSize)
+            {
+                juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, hostBlockSize);
+                processor.processBlock(block, midi);
+            }
+        };
+
+        SimpleEQAudioProcessor multiChannel;
+        prepare(multiChannel, numChannels);
+        expectEquals(multiChannel.getTotalNumOutputChannels(), numChannels);
+
+        juce::AudioBuffer<SampleType> output(input);
+        process(multiChannel, output);
+        expect(isFinite(output));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            SimpleEQAudioProcessor mono;
+            prepare(mono, 1);
+
+            juce::AudioBuffer<SampleType> expected(1, input.getNumSamples());
+            expected.copyFrom(0, 0, input, ch, 0, input.getNumSamples());
+            process(mono, expected);
+
+            juce::AudioBuffer<SampleType> channel(output.getArrayOfWritePointers() + ch, 1, output.getNumSamples());
+            expectEquals(getMaxDifference(channel, expected), SampleType(0));
+        }
+    }
+};
+
+static ChainPoolTest chainPoolTest;
+
+//==============================================================================
+// the state variable sections against the biquads they stand in for
+// same designs, so in double the two engines have to agree; in float at low cutoffs the SVF is the accurate one
+struct FilterTopologyTest : juce::UnitTest
+{
+    FilterTopologyTest() : juce::UnitTest("Filter topology", "SimpleEQ") { }
+
+    // 'input' through a SIMDChain with the given topology
+    template<typename SampleType>
+    static juce::AudioBuffer<SampleType> process(const ChainSettings& settings, double sampleRate, FilterTopology topology,
+                                                 const juce::AudioBuffer<SampleType>& input)
+    {
+        SIMDChain<SampleType> chain;
+        chain.prepare(input.getNumChannels(), 512, topology);
+        chain.setCoefficients(designChainCoefficients<SampleType>(settings, sampleRate, topology));
+
+        juce::AudioBuffer<SampleType> output(input);
+        juce::dsp::AudioBlock<SampleType> block(output);
+        chain.process(block);
+        return output;
+    }
+
+    static ChainSettings getBandOnly(ChainSettings settings, ChainPositions band)
+    {
+        settings.lowCutBypassed = band != ChainPositions::LowCut;
+        settings.peakBypassed = band != ChainPositions::Peak;
+        settings.highCutBypassed = band != ChainPositions::HighCut;
+        return settings;
+    }
+
+    void runTest() override
+    {
+        juce::Random random(6);
+
+        beginTest("double: the same output for the peak and every cut slope");
+        {
+            constexpr double sampleRate = 48000.0;
+            juce::AudioBuffer<double> input(2, 4800);
+            fillWithNoise(input, random);
+
+            for (auto slope : { Slope::Slope_12, Slope::Slope_24, Slope::Slope_36, Slope::Slope_48 })
+            {
+                ChainSettings settings;
+                settings.lowCutFreq = 80.f;
+                settings.lowCutSlope = slope;
+                settings.peakFreq = 1200.f;
+                settings.peakGainInDecibels = slope % 2 == 0 ? 9.f : -9.f;
+                settings.peakQuality = 2.f;
+                settings.highCutFreq = 9000.f;
+                settings.highCutSlope = slope;
+
+                for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+                {
+                    const auto bandOnly = getBandOnly(settings, band);
+                    const auto biquad = process(bandOnly, sampleRate, FilterTopology::TransposedDirectForm2, input);
+                    const auto svf = process(bandOnly, sampleRate, FilterTopology::StateVariable, input);
+                    expectLessThan(getMaxDifference(svf, biquad), 1.0e-9);
+                }
+
+                const auto biquad = process(settings, sampleRate, FilterTopology::TransposedDirectForm2, input);
+                const auto svf = process(settings, sampleRate, FilterTopology::StateVariable, input);
+                expectLessThan(getMaxDifference(svf, biquad), 1.0e-9);
+            }
+        }
+
+        // a 20Hz 48dB/oct low cut and a 30Hz bell: the biquad coefficients sit right next to 1 and -2
+        for (auto sampleRate : { 96000.0, 192000.0 })
+        {
+            beginTest("float, low cutoffs at " + juce::String(sampleRate / 1000.0) + "kHz: the SVF stays with the double biquads");
+
+            ChainSettings settings;
+            settings.lowCutFreq = 20.f;
+            settings.lowCutSlope = Slope::Slope_48;
+            settings.peakFreq = 30.f;
+            settings.peakGainInDecibels = 12.f;
+            settings.peakQuality = 4.f;
+            settings.highCutBypassed = true;
+
+            juce::AudioBuffer<double> input(2, (int)sampleRate / 2);
+            fillWithNoise(input, random);
+            juce::AudioBuffer<float> floatInput(2, input.getNumSamples());
+            floatInput.makeCopyOf(input);
+
+            const auto reference = process(settings, sampleRate, FilterTopology::TransposedDirectForm2, input);
+
+            auto getError = [&](const juce::AudioBuffer<float>& output)
+            {
+                double error = 0.0;
+                for (int ch = 0; ch < output.getNumChannels(); ++ch)
+                    for (int i = 0; i < output.getNumSamples(); ++i)
+                        error = juce::jmax(error, std::abs((double)output.getSample(ch, i) - reference.getSample(ch, i)));
+                return error;
+            };
+
+            const auto biquadError = getError(process(settings, sampleRate, FilterTopology::TransposedDirectForm2, floatInput));
+            const auto svfError = getError(process(settings, sampleRate, FilterTopology::StateVariable, floatInput));
+
+            // about 1e-5 for the SVF, 1e-2 for the float biquads
+            expectLessThan(svfError, 1.0e-4);
+            expectLessThan(svfError * 10.0, biquadError);
+        }
+
+        beginTest("switching the parameter after prepareToPlay rebuilds the chains");
+        {
+            constexpr double sampleRate = 48000.0;
+            constexpr int blockSize = 256;
+
+            SimpleEQAudioProcessor switched, preparedWithSVF;
+            setParameter(preparedWithSVF, "Filter Topology", (float)FilterTopology::StateVariable);
+
+            for (auto* processor : { &switched, &preparedWithSVF })
+            {
+                setTestSettings(*processor);
+                processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor->prepareToPlay(sampleRate, blockSize);
+            }
+
+            expectEquals((int)switched.getFilterTopology(), (int)FilterTopology::TransposedDirectForm2);
+
+            // this thread is the message thread, so the switch happens before setParameter returns
+            setParameter(switched, "Filter Topology", (float)FilterTopology::StateVariable);
+            expectEquals((int)switched.getFilterTopology(), (int)FilterTopology::StateVariable);
+
+            juce::AudioBuffer<float> switchedOutput(2, blockSize), preparedOutput(2, blockSize);
+            processSines(switched, switchedOutput, sampleRate, 0.25);
+            processSines(preparedWithSVF, preparedOutput, sampleRate, 0.25);
+
+            expect(isFinite(switchedOutput));
+            expectLessThan(getMaxDifference(switchedOutput, preparedOutput), 1.0e-6f);
+        }
+    }
+};
+
+static FilterTopologyTest filterTopologyTest;
+
+//==============================================================================
+// the ramps redesign from the smoothed values, but where they end has to be exactly the designer's result
+// (no float drift left in the filters once the parameters stop moving)
+struct ChainSmootherTest : juce::UnitTest
+{
+    ChainSmootherTest() : juce::UnitTest("ChainSmoother", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        for (auto topology : { FilterTopology::TransposedDirectForm2, FilterTopology::StateVariable })
+        {
+            const juce::String name = topology == FilterTopology::StateVariable ? "state variable" : "biquads";
+
+            beginTest("float, " + name + ": every band ends up on the designer's coefficients");
+            run<float>(topology);
+
+            beginTest("double, " + name + ": every band ends up on the designer's coefficients");
+            run<double>(topology);
+        }
+    }
+
+    template<typename SampleType>
+    void run(FilterTopology topology)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr double rampLengthSeconds = 0.05;
+        constexpr int stride = 32;
+
+        ChainSettings from;
+        from.lowCutFreq = 30.f;
+        from.peakFreq = 500.f;
+        from.peakGainInDecibels = -6.f;
+        from.peakQuality = 0.7f;
+        from.highCutFreq = 18000.f;
+
+        // every smoothed value moves (the multiplicative ramps land on awkward floats), the slopes switch
+        ChainSettings to;
+        to.lowCutFreq = 173.3f;
+        to.lowCutSlope = Slope::Slope_36;
+        to.peakFreq = 2711.f;
+        to.peakGainInDecibels = 7.3f;
+        to.peakQuality = 3.1f;
+        to.highCutFreq = 6123.f;
+        to.highCutSlope = Slope::Slope_24;
+
+        const auto expected = designChainCoefficients<SampleType>(to, sampleRate, topology);
+
+        ChainSmoother<SampleType> smoother;
+        smoother.prepare(sampleRate, rampLengthSeconds);
+        smoother.reset(designChainCoefficients<SampleType>(from, sampleRate, topology));
+        smoother.setTarget(expected);
+
+        constexpr int allBands = (1 << ChainPositions::LowCut) | (1 << ChainPositions::Peak) | (1 << ChainPositions::HighCut);
+        expect(smoother.isSmoothing());
+
+        ChainCoefficients<SampleType> result;
+        expectEquals(smoother.process(stride, result), allBands);
+
+        // the first step is on the way, not at the target yet
+        expect(! sameCoefficients(result, expected));
+
+        int numSamples = stride;
+        while ( smoother.isSmoothing() && numSamples < sampleRate )
+        {
+            smoother.process(stride, result);
+            numSamples += stride;
+        }
+
+        // the ramp plus the call that notices it's over
+        expect(! smoother.isSmoothing());
+        expectLessOrEqual(numSamples, juce::roundToInt(rampLengthSeconds * sampleRate) + 2 * stride);
+
+        // bit for bit, every array of the topology
+        expect(sameCoefficients(result, expected));
+        expect(result.settings.lowCutSlope == to.lowCutSlope && result.settings.highCutSlope == to.highCutSlope);
+
+        // and nothing more to do
+        expectEquals(smoother.process(stride, result), 0);
+        expect(sameCoefficients(result, expected));
+    }
+
+    template<typename SampleType>
+    static bool sameCoefficients(const ChainCoefficients<SampleType>& a, const ChainCoefficients<SampleType>& b)
+    {
+        return a.topology == b.topology
+            && a.peak == b.peak && a.lowCut == b.lowCut && a.highCut == b.highCut
+            && a.peakSVF == b.peakSVF && a.lowCutSVF == b.lowCutSVF && a.highCutSVF == b.highCutSVF;
+    }
+};
+
+static ChainSmootherTest chainSmootherTest;
+
+//==============================================================================
+// the batch response evaluator against getMagnitudeForFrequency on the MonoChain
+struct FrequencyResponseEvaluatorTest : juce::UnitTest
+{
+    FrequencyResponseEvaluatorTest() : juce::UnitTest("FrequencyResponseEvaluator", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        // odd, so the last SIMD register is only partly used
+        constexpr int numPoints = 1001;
+
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.lowCutSlope = Slope::Slope_36;
+        settings.peakFreq = 1200.f;
+        settings.peakGainInDecibels = -9.f;
+        settings.peakQuality = 2.f;
+        settings.highCutFreq = 9000.f;
+        settings.highCutSlope = Slope::Slope_48;
+
+        FrequencyResponseEvaluator evaluator;
+        evaluator.prepareLogGrid(numPoints, sampleRate);
+        expectEquals(evaluator.getNumFrequencies(), numPoints);
+
+        std::vector<double> decibels((size_t)numPoints);
+
+        auto getMaxError = [&](MonoChain<double>& chain)
+        {
+            double maxError = 0.0;
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto frequency = juce::mapToLog10(double(i) / double(numPoints), 20.0, 20000.0);
+                const auto expected = juce::Decibels::gainToDecibels(getMagnitudeForFrequency(chain, frequency, sampleRate), -100.0);
+                maxError = juce::jmax(maxError, std::abs(decibels[(size_t)i] - expected));
+            }
+            return maxError;
+        };
+
+        beginTest("the whole chain");
+        {
+            const auto coefficients = designChainCoefficients<double>(settings, sampleRate);
+            MonoChain<double> chain;
+            applyChainCoefficients(chain, coefficients);
+
+            evaluator.getChainDecibels(coefficients, decibels.data());
+            expectLessThan(getMaxError(chain), 1.0e-6);
+        }
+
+        beginTest("one band at a time, a bypassed band is 0dB");
+        {
+            settings.peakBypassed = true;
+            const auto coefficients = designChainCoefficients<double>(settings, sampleRate);
+
+            evaluator.getBandDecibels(coefficients, ChainPositions::Peak, decibels.data());
+            for (auto dB : decibels)
+                expectEquals(dB, 0.0);
+
+            // the low cut on its own: the same design with the other bands bypassed
+            auto lowCutOnly = settings;
+            lowCutOnly.highCutBypassed = true;
+            MonoChain<double> chain;
+            applyChainCoefficients(chain, designChainCoefficients<double>(lowCutOnly, sampleRate));
+
+            evaluator.getBandDecibels(coefficients, ChainPositions::LowCut, decibels.data());
+            expectLessThan(getMaxError(chain), 1.0e-6);
+        }
+    }
+};
+
+static FrequencyResponseEvaluatorTest frequencyResponseEvaluatorTest;
+
+//==============================================================================
+struct OversamplingTest : juce::UnitTest
+{
+    OversamplingTest() : juce::UnitTest("Oversampling", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 256;
+
+        for (auto stages : { 1, 2, 3 })
+        {
+            beginTest(juce::String(1 << stages) + "x: latency, and host blocks bigger than the prepared size");
+
+            // one processor gets the audio in one big block, the other in prepared-size blocks
+            SimpleEQAudioProcessor bigBlocks, preparedBlocks;
+            for (auto* processor : { &bigBlocks, &preparedBlocks })
+            {
+                setTestSettings(*processor);
+                setParameter(*processor, "Oversampling", (float)stages);
+                processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor->prepareToPlay(sampleRate, blockSize);
+            }
+
+            expectEquals(bigBlocks.getFilterSampleRate(), sampleRate * (1 << stages));
+            expectGreaterThan(bigBlocks.getLatencySamples(), 0);
+            expectEquals(bigBlocks.getTailLengthSeconds(), bigBlocks.getLatencySamples() / sampleRate);
+
+            juce::AudioBuffer<float> input(2, blockSize * 4 - 24);
+            juce::Random random(5);
+            fillWithNoise(input, random);
+
+            juce::MidiBuffer midi;
+            juce::AudioBuffer<float> bigBlockOutput(input);
+            bigBlocks.processBlock(bigBlockOutput, midi);
+
+            juce::AudioBuffer<float> preparedBlockOutput(input);
+            for (int start = 0; start < input.getNumSamples(); start += blockSize)
+            {
+                juce::AudioBuffer<float> block(preparedBlockOutput.getArrayOfWritePointers(), 2, start,
+                                               juce::jmin(blockSize, input.getNumSamples() - start));
+                preparedBlocks.processBlock(block, midi);
+            }
+
+            // same chunks, same result
+            expectEquals(getMaxDifference(bigBlockOutput, preparedBlockOutput), 0.f);
+            expect(isFinite(bigBlockOutput));
+        }
+
+        beginTest("switching after prepareToPlay: the reported latency is the oversampler's, and the host hears about it");
+        {
+            // counts the updateHostDisplay() calls that say the latency changed
+            struct LatencyListener : juce::AudioProcessorListener
+            {
+                void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override { }
+                void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails& details) override
+                {
+                    if ( details.latencyChanged )
+                        ++numLatencyChanges;
+                }
+
+                int numLatencyChanges = 0;
+            };
+
+            SimpleEQAudioProcessor processor;
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+            expectEquals(processor.getLatencySamples(), 0);
+
+            LatencyListener listener;
+            processor.addListener(&listener);
+
+            using Oversampling = juce::dsp::Oversampling<float>;
+
+            for (auto filter : { OversamplingFilter::PolyphaseIIR, OversamplingFilter::EquirippleFIR })
+            {
+                setParameter(processor, "Oversampling Filter", (float)filter);
+
+                for (auto stages : { 1, 2, 3, 0 })
+                {
+                    const auto changesBefore = listener.numLatencyChanges;
+                    const auto latencyBefore = processor.getLatencySamples();
+
+                    // this thread is the message thread, so the re-prepare happens before setParameter returns
+                    setParameter(processor, "Oversampling", (float)stages);
+
+                    int expectedLatency = 0;
+                    if ( stages > 0 )
+                    {
+                        Oversampling oversampling(2, (size_t)stages,
+                                                  filter == OversamplingFilter::EquirippleFIR ? Oversampling::filterHalfBandFIREquiripple
+                                                                                              : Oversampling::filterHalfBandPolyphaseIIR,
+                                                  true, true);
+                        oversampling.initProcessing((size_t)blockSize);
+                        expectedLatency = juce::roundToInt(oversampling.getLatencyInSamples());
+                    }
+
+                    expectEquals(processor.getLatencySamples(), expectedLatency);
+                    expectEquals(processor.getFilterSampleRate(), sampleRate * (1 << stages));
+                    expectEquals(processor.getTailLengthSeconds(), expectedLatency / sampleRate);
+
+                    if ( expectedLatency != latencyBefore )
+                        expectEquals(listener.numLatencyChanges, changesBefore + 1);
+
+                    juce::AudioBuffer<float> buffer(2, blockSize);
+                    processSines(processor, buffer, sampleRate, 0.05);
+                    expect(isFinite(buffer));
+                }
+            }
+
+            processor.removeListener(&listener);
+        }
+    }
+};
+
+static OversamplingTest oversamplingTest;
+
+//==============================================================================
+struct DoublePrecisionTest : juce::UnitTest
+{
+    DoublePrecisionTest() : juce::UnitTest("Double precision", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+
+        beginTest("processBlock(AudioBuffer<double>) gives the float result");
+
+        SimpleEQAudioProcessor floatProcessor, doubleProcessor;
+        doubleProcessor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+        for (auto* processor : { &floatProcessor, &doubleProcessor })
+        {
+            setTestSettings(*processor);
+            processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor->prepareToPlay(sampleRate, blockSize);
+        }
+
+        juce::AudioBuffer<float> floatOutput(2, blockSize);
+        juce::AudioBuffer<double> doubleOutput(2, blockSize);
+        processSines(floatProcessor, floatOutput, sampleRate, 0.5);
+        processSines(doubleProcessor, doubleOutput, sampleRate, 0.5);
+
+        juce::AudioBuffer<float> doubleAsFloat(2, blockSize);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                doubleAsFloat.setSample(ch, i, (float)doubleOutput.getSample(ch, i));
+
+        expect(isFinite(doubleOutput));
+        expectLessThan(getMaxDifference(floatOutput, doubleAsFloat), 1.0e-4f);
+    }
+};
+
+static DoublePrecisionTest doublePrecisionTest;
+
+//==============================================================================
+struct FifoTest : juce::UnitTest
+{
+    FifoTest() : juce::UnitTest("Fifo", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        beginTest("Capacity slots, oldest first");
+
+        Fifo<int, 4> fifo;
+        for (int i = 0; i < 4; ++i)
+            expect(fifo.push(i));
+
+        expect(! fifo.push(4), "a full fifo takes nothing");
+        expectEquals(fifo.getNumAvailableForReading(), 4);
+
+        int value = -1;
+        expect(fifo.pull(value));
+        expectEquals(value, 0);
+
+        beginTest("still Capacity items after wrapping around");
+
+        for (int i = 4; i < 20; ++i)
+        {
+            expect(fifo.push(i));
+            expectEquals(fifo.getNumAvailableForReading(), 4);
+            expect(fifo.pull(value));
+            expectEquals(value, i - 3);
+        }
+
+        beginTest("a single slot fifo holds one item");
+
+        Fifo<int, 1> singleFifo;
+        expect(singleFifo.push(1));
+        expect(! singleFifo.push(2));
+        expect(singleFifo.pull(value));
+        expectEquals(value, 1);
+
+        beginTest("swapping hands the slot's previous buffer back");
+
+        Fifo<std::vector<float>, 2> vectorFifo;
+        vectorFifo.prepare(8);
+
+        std::vector<float> data(8, 1.f);
+        const auto* pushedStorage = data.data();
+        expect(vectorFifo.pushBySwapping(data));
+        expectEquals((int)data.size(), 8, "got a prepared slot back");
+
+        std::vector<float> result(8, 0.f);
+        expect(vectorFifo.pullBySwapping(result));
+        expect(result.data() == pushedStorage, "the same storage came out, nothing was copied");
+        expectEquals(result[0], 1.f);
+
+        beginTest("in place: the callbacks see the slot itself");
+
+        expect(vectorFifo.pushInPlace([](std::vector<float>& slot) { slot[0] = 2.f; }));
+        float pulled = 0.f;
+        expect(vectorFifo.pullInPlace([&pulled](std::vector<float>& slot) { pulled = slot[0]; }));
+        expectEquals(pulled, 2.f);
+        expect(! vectorFifo.pullInPlace([](std::vector<float>&) { }), "nothing left");
+    }
+};
+
+static FifoTest fifoTest;
+
+//==============================================================================
+struct LatestValueSlotTest : juce::UnitTest
+{
+    LatestValueSlotTest() : juce::UnitTest("LatestValueSlot", "SimpleEQ") { }
+
+    void runTest() override
+    {
+        LatestValueSlot<std::vector<float>> slot;
+        std::vector<float> result;
+
+        beginTest("only the newest value comes out, once");
+
+        expect(! slot.pullBySwapping(result), "nothing pushed yet");
+
+        for (int i = 1; i <= 3; ++i)
+            slot.pushInPlace([i](std::vector<float>& value) { value.assign(4, (float)i); });
+
+        expect(slot.pullBySwapping(result));
+        expectEquals((int)result.size(), 4);
+        expectEquals(result[0], 3.f);
+        expect(! slot.pullBySwapping(result), "nothing new since the last pull");
+
+        beginTest("copying and in place / swapping mix");
+
+        slot.push(std::vector<float>(2, 7.f));
+        expect(slot.pull(result));
+        expectEquals((int)result.size(), 2);
+        expectEquals(result[0], 7.f);
+    }
+};
+
+static LatestValueSlotTest latestValueSlotTest;
+
+//==============================================================================
+// the analyzer's capture ring: any host block size in, fixed blocks with positions out
+struct MultiChannelSampleFifoTest : juce::UnitTest
+{
+    MultiChannelSampleFifoTest() : juce::UnitTest("MultiChannelSampleFifo", "SimpleEQ") { }
+
+    using CaptureFifo = MultiChannelSampleFifo<juce::AudioBuffer<float>>;
+
+    // sample n of the stream is n on channel 0 and -n on channel 1
+    static void fillWithPositions(juce::AudioBuffer<float>& buffer, juce::int64 position)
+    {
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            buffer.setSample(0, i, (float)(position + i));
+            if ( buffer.getNumChannels() > 1 )
+                buffer.setSample(1, i, -(float)(position + i));
+        }
+    }
+
+    // reads every complete block, they have to follow on from 'expectedPosition' and hold the right samples
+    int readAndCheck(CaptureFifo& fifo, juce::int64& expectedPosition)
+    {
+        int numBlocks = 0;
+        bool allGood = true;
+
+        while ( fifo.readBlock([&](const CaptureFifo::CapturedBlock& block)
+        {
+            allGood = allGood && block.position == expectedPosition;
+            for (int i = 0; i < block.buffer.getNumSamples(); ++i)
+            {
+                allGood = allGood && block.buffer.getSample(0, i) == (float)(block.position + i)
+                                  && block.buffer.getSample(1, i) == -(float)(block.position + i);
+            }
+
+            expectedPosition = block.position + block.buffer.getNumSamples();
+            ++numBlocks;
+        }) ) { }
+
+        expect(allGood, "contiguous positions, samples in order");
+        return numBlocks;
+    }
+
+    void runTest() override
+    {
+        beginTest("the ring covers minRingSeconds and minHostBlocks host blocks");
+
+        for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+        {
+            for (auto hostBlockSize : { 1, 32, 512, 8192 })
+            {
+                const auto blockSize = CaptureFifo::getBlockSizeFor(sampleRate, hostBlockSize);
+                expectGreaterOrEqual(CaptureFifo::numSlots * blockSize / sampleRate, CaptureFifo::minRingSeconds);
+                expectGreaterOrEqual(CaptureFifo::numSlots * blockSize, CaptureFifo::minHostBlocks * hostBlockSize);
+            }
+        }
+
+        beginTest("32 sample host blocks at 96kHz, read once per 16ms frame: nothing dropped");
+        {
+            constexpr double sampleRate = 96000.0;
+            constexpr int hostBlockSize = 32;
+
+            CaptureFifo fifo;
+            fifo.prepare(2, CaptureFifo::getBlockSizeFor(sampleRate, hostBlockSize));
+
+            juce::AudioBuffer<float> hostBlock(2, hostBlockSize);
+            juce::int64 written = 0, expectedPosition = 0;
+            const auto hostBlocksPerFrame = juce::roundToInt(0.016 * sampleRate / hostBlockSize);
+
+            // 2 seconds, and one frame where the reader is 5 frames late
+            for (int frame = 0; frame < 125; ++frame)
+            {
+                const auto numHostBlocks = hostBlocksPerFrame * (frame == 60 ? 6 : 1);
+                for (int i = 0; i < numHostBlocks; ++i)
+                {
+                    fillWithPositions(hostBlock, written);
+                    fifo.update(hostBlock);
+                    written += hostBlockSize;
+                }
+
+                readAndCheck(fifo, expectedPosition);
+            }
+
+            expectEquals((int)fifo.getNumDroppedBlocks(), 0);
+            expectEquals(fifo.getWritePosition(), written);
+        }
+
+        beginTest("odd and oversized host blocks, float and double");
+        {
+            constexpr int blockSize = 240;
+            CaptureFifo fifo;
+            fifo.prepare(2, blockSize);
+
+            juce::int64 written = 0, expectedPosition = 0;
+            int numBlocks = 0;
+
+            // smaller, a single sample, several blocks at once, not a divisor
+            for (auto hostBlockSize : { 37, 1, 1000, 241, 239, 7, 3 * blockSize })
+            {
+                juce::AudioBuffer<float> floatBlock(2, hostBlockSize);
+                fillWithPositions(floatBlock, written);
+                fifo.update(floatBlock);
+                written += hostBlockSize;
+
+                juce::AudioBuffer<double> doubleBlock(2, hostBlockSize);
+                for (int i = 0; i < hostBlockSize; ++i)
+                {
+                    doubleBlock.setSample(0, i, (double)(written + i));
+                    doubleBlock.setSample(1, i, -(double)(written + i));
+                }
+                fifo.update(doubleBlock);
+                written += hostBlockSize;
+
+                numBlocks += readAndCheck(fifo, expectedPosition);
+            }
+
+            expectEquals(numBlocks, (int)(written / blockSize), "every complete block came out");
+            expectEquals((int)fifo.getNumDroppedBlocks(), 0);
+        }
+
+        beginTest("a full ring drops (and counts) the new blocks, the reader sees the gap");
+        {
+            constexpr int blockSize = 64;
+            constexpr int numExtraBlocks = 5;
+            CaptureFifo fifo;
+            fifo.prepare(2, blockSize);
+
+            juce::AudioBuffer<float> hostBlock(2, blockSize);
+            juce::int64 written = 0;
+            for (int i = 0; i < CaptureFifo::numSlots + numExtraBlocks; ++i)
+            {
+                fillWithPositions(hostBlock, written);
+                fifo.update(hostBlock);
+                written += blockSize;
+            }
+
+            expectEquals((int)fifo.getNumDroppedBlocks(), numExtraBlocks);
+
+            juce::int64 expectedPosition = 0;
+            expectEquals(readAndCheck(fifo, expectedPosition), CaptureFifo::numSlots, "the oldest blocks are kept");
+
+            fillWithPositions(hostBlock, written);
+            fifo.update(hostBlock);
+
+            juce::int64 nextPosition = -1;
+            expect(fifo.readBlock([&](const CaptureFifo::CapturedBlock& block) { nextPosition = block.position; }));
+            expectEquals(nextPosition, written, "the next block starts after the dropped ones");
+        }
+    }
+};
+
+static MultiChannelSampleFifoTest multiChannelSampleFifoTest;